@@ -1,43 +1,35 @@
 #include <SDL3/SDL.h>
 #include <iostream>
-#include <fstream>
+#include <algorithm>
 #include <string>
 #include <vector>
-#include <sstream>
+#include "../common/csv_map.h"
+#include "../common/level_file.h"
+#include "../common/tile_grid.h"
 
 const int SCREEN_WIDTH = 1920;
 const int SCREEN_HEIGHT = 1080;
 const int BLOCK_SIZE = 32; // Example block size
 
-// Function to load the map from a file
-std::vector<std::vector<int>> loadMap(const std::string& filename) {
-    std::vector<std::vector<int>> mapData;
-    std::ifstream file(filename);
-
-    if (!file.is_open()) {
-        std::cerr << "Error opening map file: " << filename << std::endl;
-        return mapData; // Return empty if file fails to open
+// Function to load the map from a file: a binary level (.lvl), or CSV
+// with comma-separated block types per row, short rows padded with 0
+TileGrid loadMap(const std::string& filename) {
+    TileGrid mapData;
+    if (isLevelFile(filename)) {
+        LevelFile level;
+        if (level.open(filename)) {
+            copyGrid(level.layer<TileGrid::Tile>(0), mapData);
+        }
+        return mapData;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::vector<int> row;
-        std::stringstream ss(line);
-        std::string value;
-
-        while (std::getline(ss, value, ',')) {
-            try {
-                row.push_back(std::stoi(value));
-            } catch (const std::invalid_argument& e) {
-                std::cerr << "Invalid number in map file: " << value << std::endl;
-                // Handle the error, e.g., skip the invalid value
-            } catch (const std::out_of_range& e) {
-                std::cerr << "Number out of range in map file: " << value << std::endl;
-            }
-        }
-        mapData.push_back(row);
+    // Parsed on every core; bad cells load as 0 and are reported
+    std::vector<CsvMapError> errors;
+    loadCsvGrid(filename, mapData, errors);
+    for (const CsvMapError& error : errors) {
+        std::cerr << "Bad block type in map file at row " << error.row << ", column " << error.column
+                  << ": '" << error.cell << "'" << std::endl;
     }
-    file.close();
     return mapData;
 }
 
@@ -60,7 +52,7 @@ int main(int argc, char* argv[]) {
     }
 
 
-    std::vector<std::vector<int>> map = loadMap("map.txt");
+    TileGrid map = loadMap(argc > 1 ? argv[1] : "map.txt");
 
     // Example: Load block textures.  Replace these with your actual block loading logic
     std::vector<SDL_Texture*> blockTextures;
@@ -101,9 +93,10 @@ int main(int argc, char* argv[]) {
         SDL_RenderClear(renderer);
 
         // Draw the map
-        for (size_t y = 0; y < map.size(); ++y) {
-            for (size_t x = 0; x < map[y].size(); ++x) {
-                int blockType = map[y][x];
+        for (int y = 0; y < map.height(); ++y) {
+            auto row = map.row(y);
+            for (int x = 0; x < row.size(); ++x) {
+                int blockType = row[x];
                 if (blockType > 0 && blockType < blockTextures.size() && blockTextures[blockType]) { // Check for valid block type and texture
                     SDL_Rect destRect = { static_cast<int>(x * BLOCK_SIZE), static_cast<int>(y * BLOCK_SIZE), BLOCK_SIZE, BLOCK_SIZE };
                     SDL_RenderCopy(renderer, blockTextures[blockType], nullptr, &destRect);
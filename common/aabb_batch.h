@@ -0,0 +1,197 @@
+#ifndef AABB_BATCH_H
+#define AABB_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AABB_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+// Batched axis-aligned box overlap tests, shared by the games.
+//
+// Boxes are given as structure-of-arrays int32 x, y, w, h. One query box is
+// tested against many boxes at once, 4 per step with SSE2 or 8 with AVX2,
+// picked at runtime from what the CPU supports, with a scalar loop for the
+// tail and for other CPUs. Results come back as a bitmask, bit i of word
+// i / 64 set when box i overlaps. Overlap has strict edges, like
+// SDL_HasIntersection: boxes that only touch do not overlap.
+//
+// Header only; include it and call the functions.
+
+namespace aabb {
+
+enum SimdLevel {
+    SIMD_SCALAR,
+    SIMD_SSE2,
+    SIMD_AVX2
+};
+
+// A run of boxes in structure-of-arrays form
+struct BoxesSoA {
+    const std::int32_t* x;
+    const std::int32_t* y;
+    const std::int32_t* w;
+    const std::int32_t* h;
+    std::size_t count;
+};
+
+// Words needed for a mask over count boxes
+inline std::size_t maskWords(std::size_t count) {
+    return (count + 63) / 64;
+}
+
+inline bool testBit(const std::uint64_t* mask, std::size_t i) {
+    return (mask[i / 64] >> (i % 64)) & 1;
+}
+
+// Best level this CPU supports
+inline SimdLevel detectSimdLevel() {
+#ifdef AABB_BATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SIMD_SSE2;
+    }
+#endif
+    return SIMD_SCALAR;
+}
+
+// Level used by the functions below. Starts at detectSimdLevel(); lower it
+// to compare paths. Raising it past what the CPU supports is ignored.
+inline SimdLevel& simdLevel() {
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+inline void setSimdLevel(SimdLevel level) {
+    simdLevel() = level <= detectSimdLevel() ? level : detectSimdLevel();
+}
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SIMD_AVX2: return "AVX2";
+    case SIMD_SSE2: return "SSE2";
+    default: return "scalar";
+    }
+}
+
+// The query box's edges, computed once
+struct Query {
+    std::int32_t left, right, top, bottom;
+};
+
+inline Query makeQuery(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h) {
+    return { x, x + w, y, y + h };
+}
+
+// Scalar kernel for boxes [begin, end). Fills whole mask words and returns
+// the number of hits. begin must be a multiple of 64 so the words line up.
+inline std::size_t overlapScalar(const Query& q, const BoxesSoA& boxes, std::size_t begin, std::size_t end, std::uint64_t* mask) {
+    std::size_t hits = 0;
+    for (std::size_t word = begin; word < end; word += 64) {
+        std::size_t stop = end - word < 64 ? end : word + 64;
+        std::uint64_t bits = 0;
+        for (std::size_t i = word; i < stop; ++i) {
+            // & rather than && so there is no branch per box
+            bool hit = (q.left < boxes.x[i] + boxes.w[i]) & (q.right > boxes.x[i])
+                       & (q.top < boxes.y[i] + boxes.h[i]) & (q.bottom > boxes.y[i]);
+            bits |= static_cast<std::uint64_t>(hit) << (i - word);
+        }
+        mask[word / 64] = bits;
+        hits += __builtin_popcountll(bits);
+    }
+    return hits;
+}
+
+#ifdef AABB_BATCH_X86
+// 4 boxes per step. Returns the index the scalar tail starts at.
+__attribute__((target("sse2")))
+inline std::size_t overlapSse2(const Query& q, const BoxesSoA& boxes, std::uint64_t* mask, std::size_t& hits) {
+    const __m128i left = _mm_set1_epi32(q.left);
+    const __m128i right = _mm_set1_epi32(q.right);
+    const __m128i top = _mm_set1_epi32(q.top);
+    const __m128i bottom = _mm_set1_epi32(q.bottom);
+    std::size_t full = boxes.count / 64 * 64;
+    for (std::size_t word = 0; word < full; word += 64) {
+        std::uint64_t bits = 0;
+        for (std::size_t i = 0; i < 64; i += 4) {
+            std::size_t k = word + i;
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(boxes.x + k));
+            __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(boxes.y + k));
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(boxes.w + k));
+            __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(boxes.h + k));
+            __m128i hit = _mm_and_si128(_mm_cmpgt_epi32(_mm_add_epi32(x, w), left), _mm_cmpgt_epi32(right, x));
+            hit = _mm_and_si128(hit, _mm_cmpgt_epi32(_mm_add_epi32(y, h), top));
+            hit = _mm_and_si128(hit, _mm_cmpgt_epi32(bottom, y));
+            bits |= static_cast<std::uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(hit))) << i;
+        }
+        mask[word / 64] = bits;
+        hits += __builtin_popcountll(bits);
+    }
+    return full;
+}
+
+// 8 boxes per step. Returns the index the scalar tail starts at.
+__attribute__((target("avx2")))
+inline std::size_t overlapAvx2(const Query& q, const BoxesSoA& boxes, std::uint64_t* mask, std::size_t& hits) {
+    const __m256i left = _mm256_set1_epi32(q.left);
+    const __m256i right = _mm256_set1_epi32(q.right);
+    const __m256i top = _mm256_set1_epi32(q.top);
+    const __m256i bottom = _mm256_set1_epi32(q.bottom);
+    std::size_t full = boxes.count / 64 * 64;
+    for (std::size_t word = 0; word < full; word += 64) {
+        std::uint64_t bits = 0;
+        for (std::size_t i = 0; i < 64; i += 8) {
+            std::size_t k = word + i;
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(boxes.x + k));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(boxes.y + k));
+            __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(boxes.w + k));
+            __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(boxes.h + k));
+            __m256i hit = _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_add_epi32(x, w), left), _mm256_cmpgt_epi32(right, x));
+            hit = _mm256_and_si256(hit, _mm256_cmpgt_epi32(_mm256_add_epi32(y, h), top));
+            hit = _mm256_and_si256(hit, _mm256_cmpgt_epi32(bottom, y));
+            bits |= static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(hit))) << i;
+        }
+        mask[word / 64] = bits;
+        hits += __builtin_popcountll(bits);
+    }
+    return full;
+}
+#endif
+
+// One box against every box in boxes. mask needs maskWords(boxes.count)
+// words; all of them are written. Returns the number of hits.
+inline std::size_t overlapOneVsMany(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h,
+                                    const BoxesSoA& boxes, std::uint64_t* mask) {
+    Query q = makeQuery(x, y, w, h);
+    std::size_t hits = 0;
+    std::size_t tail = 0;
+#ifdef AABB_BATCH_X86
+    if (simdLevel() == SIMD_AVX2) {
+        tail = overlapAvx2(q, boxes, mask, hits);
+    } else if (simdLevel() == SIMD_SSE2) {
+        tail = overlapSse2(q, boxes, mask, hits);
+    }
+#endif
+    return hits + overlapScalar(q, boxes, tail, boxes.count, mask);
+}
+
+// Every box in a against every box in b. Row r of the mask, words
+// r * maskWords(b.count) onwards, holds the hits of a's box r.
+// mask needs a.count * maskWords(b.count) words. Returns the number of hits.
+inline std::size_t overlapManyVsMany(const BoxesSoA& a, const BoxesSoA& b, std::uint64_t* mask) {
+    std::size_t rowWords = maskWords(b.count);
+    std::size_t hits = 0;
+    for (std::size_t r = 0; r < a.count; ++r) {
+        hits += overlapOneVsMany(a.x[r], a.y[r], a.w[r], a.h[r], b, mask + r * rowWords);
+    }
+    return hits;
+}
+
+} // namespace aabb
+
+#endif // AABB_BATCH_H
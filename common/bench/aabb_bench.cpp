@@ -0,0 +1,168 @@
+// Benchmark and cross-check for common/aabb_batch.h.
+//
+// Every SIMD level the CPU supports is checked against a one-pair-at-a-time
+// loop (the way the games test rectangles) on random boxes, including
+// touching edges and counts that leave a scalar tail, then timed on
+// one box vs N and N vs M. Exits 1 if any level disagrees.
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../aabb_batch.h"
+
+struct Rect {
+    std::int32_t x, y, w, h;
+};
+
+// Same test as checkCollision in sh.cpp and SDL_HasIntersection
+static bool overlaps(const Rect& a, const Rect& b) {
+    return a.x < b.x + b.w && a.x + a.w > b.x && a.y < b.y + b.h && a.y + a.h > b.y;
+}
+
+struct BoxSet {
+    std::vector<std::int32_t> x, y, w, h;
+
+    void add(const Rect& r) {
+        x.push_back(r.x);
+        y.push_back(r.y);
+        w.push_back(r.w);
+        h.push_back(r.h);
+    }
+
+    Rect at(std::size_t i) const {
+        return { x[i], y[i], w[i], h[i] };
+    }
+
+    aabb::BoxesSoA soa() const {
+        return { x.data(), y.data(), w.data(), h.data(), x.size() };
+    }
+};
+
+// Small coordinates on a coarse grid so touching edges come up often
+static Rect randomRect(int extent, int maxSize) {
+    return { (std::rand() % extent) * 2, (std::rand() % extent) * 2, 1 + std::rand() % maxSize, 1 + std::rand() % maxSize };
+}
+
+static BoxSet randomSet(std::size_t count, int extent, int maxSize) {
+    BoxSet set;
+    for (std::size_t i = 0; i < count; ++i) {
+        set.add(randomRect(extent, maxSize));
+    }
+    return set;
+}
+
+static bool crossCheck(aabb::SimdLevel level) {
+    aabb::setSimdLevel(level);
+    const std::size_t counts[] = { 0, 1, 3, 4, 7, 8, 63, 64, 65, 127, 200, 1000 };
+    for (std::size_t count : counts) {
+        for (int round = 0; round < 50; ++round) {
+            BoxSet boxes = randomSet(count, 32, 12);
+            Rect q = randomRect(32, 24);
+            std::vector<std::uint64_t> mask(aabb::maskWords(count) + 1, 0xDEADBEEFull);
+            std::size_t hits = aabb::overlapOneVsMany(q.x, q.y, q.w, q.h, boxes.soa(), mask.data());
+
+            std::size_t expected = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                bool hit = overlaps(q, boxes.at(i));
+                expected += hit;
+                if (aabb::testBit(mask.data(), i) != hit) {
+                    std::cerr << aabb::simdLevelName(level) << ": box " << i << " of " << count << " wrong" << std::endl;
+                    return false;
+                }
+            }
+            // Bits past count are zero, and nothing past the mask is written
+            if (count % 64 != 0 && (mask[count / 64] >> (count % 64)) != 0) {
+                std::cerr << aabb::simdLevelName(level) << ": stray bits past box " << count << std::endl;
+                return false;
+            }
+            if (mask[aabb::maskWords(count)] != 0xDEADBEEFull || hits != expected) {
+                std::cerr << aabb::simdLevelName(level) << ": overrun or wrong hit count at " << count << " boxes" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // N vs M rows
+    BoxSet a = randomSet(37, 64, 16);
+    BoxSet b = randomSet(141, 64, 16);
+    std::size_t rowWords = aabb::maskWords(b.x.size());
+    std::vector<std::uint64_t> mask(a.x.size() * rowWords);
+    aabb::overlapManyVsMany(a.soa(), b.soa(), mask.data());
+    for (std::size_t r = 0; r < a.x.size(); ++r) {
+        for (std::size_t i = 0; i < b.x.size(); ++i) {
+            if (aabb::testBit(mask.data() + r * rowWords, i) != overlaps(a.at(r), b.at(i))) {
+                std::cerr << aabb::simdLevelName(level) << ": N vs M row " << r << " box " << i << " wrong" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// "  SSE2:           " and so on, so the columns line up
+static std::string label(int level) {
+    std::string name = aabb::simdLevelName(static_cast<aabb::SimdLevel>(level));
+    return "  " + name + ":" + std::string(16 - name.size(), ' ');
+}
+
+template <typename Fn>
+static double timeNs(int reps, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < reps; ++rep) {
+        fn();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / reps;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::size_t m = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    const aabb::SimdLevel best = aabb::detectSimdLevel();
+    std::cout << "CPU supports:  " << aabb::simdLevelName(best) << std::endl;
+
+    bool ok = true;
+    for (int level = aabb::SIMD_SCALAR; level <= best; ++level) {
+        bool good = crossCheck(static_cast<aabb::SimdLevel>(level));
+        std::cout << "cross-check " << aabb::simdLevelName(static_cast<aabb::SimdLevel>(level)) << ": " << (good ? "ok" : "FAILED") << std::endl;
+        ok = ok && good;
+    }
+
+    // One box vs N, screen-sized coordinates
+    BoxSet boxes = randomSet(n, 400, 50);
+    Rect q = { 300, 200, 60, 30 };
+    std::vector<std::uint64_t> mask(aabb::maskWords(n));
+    volatile std::size_t sink = 0;
+    std::vector<Rect> rects;
+    for (std::size_t i = 0; i < n; ++i) {
+        rects.push_back(boxes.at(i));
+    }
+    std::cout << "one vs " << n << ":" << std::endl;
+    double pairNs = timeNs(20, [&] {
+        std::size_t hits = 0;
+        for (const Rect& r : rects) {
+            hits += overlaps(q, r);
+        }
+        sink = hits;
+    });
+    std::cout << "  pair at a time: " << pairNs / n << " ns/box" << std::endl;
+    for (int level = aabb::SIMD_SCALAR; level <= best; ++level) {
+        aabb::setSimdLevel(static_cast<aabb::SimdLevel>(level));
+        double ns = timeNs(20, [&] { sink = aabb::overlapOneVsMany(q.x, q.y, q.w, q.h, boxes.soa(), mask.data()); });
+        std::cout << label(level) << ns / n << " ns/box (" << pairNs / ns << "x)" << std::endl;
+    }
+
+    // N vs M
+    BoxSet a = randomSet(m, 400, 50);
+    BoxSet b = randomSet(m, 400, 50);
+    std::vector<std::uint64_t> grid(m * aabb::maskWords(m));
+    std::cout << m << " vs " << m << ":" << std::endl;
+    for (int level = aabb::SIMD_SCALAR; level <= best; ++level) {
+        aabb::setSimdLevel(static_cast<aabb::SimdLevel>(level));
+        double ns = timeNs(5, [&] { sink = aabb::overlapManyVsMany(a.soa(), b.soa(), grid.data()); });
+        std::cout << label(level) << ns / 1e6 << " ms" << std::endl;
+    }
+    (void)sink;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// Correctness checks for common/aabb_batch.h, with no timing; run by
+// `make check`. On every SIMD level the CPU supports:
+//   - boxes touching the query on an edge or corner do not overlap, and
+//     boxes one pixel further in do
+//   - every count from 0 to 260 gives the same bits and hit count as a
+//     one-pair-at-a-time loop, so each SIMD width's scalar tail is covered
+//   - bits past the last box are clear, and nothing is written past the
+//     mask's last word, for one vs N and for every row of N vs M
+// Prints each failure and exits 1 if there was any.
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "../aabb_batch.h"
+
+// Written after the mask's last word; must still be there afterwards
+const std::uint64_t GUARD = 0xA5A5A5A5A5A5A5A5ULL;
+const std::size_t GUARD_WORDS = 2;
+const std::size_t MAX_COUNT = 260;
+
+struct Rect {
+    std::int32_t x, y, w, h;
+};
+
+// Same test as checkCollision in sh.cpp and SDL_HasIntersection
+static bool overlaps(const Rect& a, const Rect& b) {
+    return a.x < b.x + b.w && a.x + a.w > b.x && a.y < b.y + b.h && a.y + a.h > b.y;
+}
+
+struct BoxSet {
+    std::vector<std::int32_t> x, y, w, h;
+
+    void add(const Rect& r) {
+        x.push_back(r.x);
+        y.push_back(r.y);
+        w.push_back(r.w);
+        h.push_back(r.h);
+    }
+
+    Rect at(std::size_t i) const {
+        return { x[i], y[i], w[i], h[i] };
+    }
+
+    // The first count boxes
+    aabb::BoxesSoA soa(std::size_t count) const {
+        return { x.data(), y.data(), w.data(), h.data(), count };
+    }
+};
+
+static int failures = 0;
+
+static void fail(aabb::SimdLevel level, const char* what, std::size_t count) {
+    std::cout << aabb::simdLevelName(level) << ": " << what << " (count " << count << ")" << std::endl;
+    ++failures;
+}
+
+// Mask of words words followed by guard words
+static std::vector<std::uint64_t> guardedMask(std::size_t words) {
+    std::vector<std::uint64_t> mask(words + GUARD_WORDS, GUARD);
+    return mask;
+}
+
+static bool guardIntact(const std::vector<std::uint64_t>& mask, std::size_t words) {
+    for (std::size_t k = words; k < mask.size(); ++k) {
+        if (mask[k] != GUARD) return false;
+    }
+    return true;
+}
+
+// Checks one row of bits and the unused bits of its last word
+static bool rowMatches(const Rect& query, const BoxSet& boxes, std::size_t count, const std::uint64_t* row) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (aabb::testBit(row, i) != overlaps(query, boxes.at(i))) return false;
+    }
+    if (count % 64 != 0 && (row[count / 64] >> (count % 64)) != 0) return false;
+    return true;
+}
+
+static void checkEdges(aabb::SimdLevel level) {
+    const Rect query = { 100, 100, 20, 20 };
+    // Touching each edge and corner from outside, then one pixel in
+    const Rect touching[] = {
+        { 120, 100, 10, 20 }, { 90, 100, 10, 20 }, { 100, 120, 20, 10 }, { 100, 90, 20, 10 },
+        { 120, 120, 10, 10 }, { 90, 90, 10, 10 }, { 120, 90, 10, 10 }, { 90, 120, 10, 10 },
+    };
+    const Rect inside[] = {
+        { 119, 100, 10, 20 }, { 91, 100, 10, 20 }, { 100, 119, 20, 10 }, { 100, 91, 20, 10 },
+        { 119, 119, 10, 10 }, { 91, 91, 10, 10 }, { 119, 91, 10, 10 }, { 91, 119, 10, 10 },
+    };
+    // Repeated so the SIMD loops, not only the scalar tail, see them
+    BoxSet boxes;
+    for (int copy = 0; copy < 4; ++copy) {
+        for (const Rect& r : touching) boxes.add(r);
+        for (const Rect& r : inside) boxes.add(r);
+    }
+    std::size_t count = boxes.x.size();
+    std::vector<std::uint64_t> mask = guardedMask(aabb::maskWords(count));
+    std::size_t hits = aabb::overlapOneVsMany(query.x, query.y, query.w, query.h, boxes.soa(count), mask.data());
+    for (std::size_t i = 0; i < count; ++i) {
+        bool inner = (i / 8) % 2 == 1;
+        if (aabb::testBit(mask.data(), i) != inner) {
+            fail(level, inner ? "box one pixel inside an edge missed" : "box touching an edge counted as overlap", i);
+            break;
+        }
+    }
+    if (hits != count / 2) fail(level, "wrong hit count for touching boxes", count);
+}
+
+static void checkCounts(aabb::SimdLevel level, const BoxSet& boxes, const Rect& query) {
+    for (std::size_t count = 0; count <= MAX_COUNT; ++count) {
+        std::size_t words = aabb::maskWords(count);
+        std::vector<std::uint64_t> mask = guardedMask(words);
+        std::size_t hits = aabb::overlapOneVsMany(query.x, query.y, query.w, query.h, boxes.soa(count), mask.data());
+        std::size_t expected = 0;
+        for (std::size_t i = 0; i < count; ++i) expected += overlaps(query, boxes.at(i));
+        if (hits != expected) fail(level, "hit count differs from the pairwise loop", count);
+        if (!rowMatches(query, boxes, count, mask.data())) fail(level, "mask bits differ from the pairwise loop", count);
+        if (!guardIntact(mask, words)) fail(level, "one vs N wrote past the mask", count);
+    }
+}
+
+static void checkManyVsMany(aabb::SimdLevel level, const BoxSet& boxes, const BoxSet& queries) {
+    const std::size_t sizes[] = { 0, 1, 7, 63, 64, 65, 130 };
+    for (std::size_t count : sizes) {
+        std::size_t rowWords = aabb::maskWords(count);
+        std::size_t rows = queries.x.size();
+        std::vector<std::uint64_t> mask = guardedMask(rows * rowWords);
+        std::size_t hits = aabb::overlapManyVsMany(queries.soa(rows), boxes.soa(count), mask.data());
+        std::size_t expected = 0;
+        for (std::size_t r = 0; r < rows; ++r) {
+            Rect query = queries.at(r);
+            for (std::size_t i = 0; i < count; ++i) expected += overlaps(query, boxes.at(i));
+            if (!rowMatches(query, boxes, count, mask.data() + r * rowWords)) {
+                fail(level, "N vs M row differs from the pairwise loop", count);
+                break;
+            }
+        }
+        if (hits != expected) fail(level, "N vs M hit count differs from the pairwise loop", count);
+        if (!guardIntact(mask, rows * rowWords)) fail(level, "N vs M wrote past the mask", count);
+    }
+}
+
+int main() {
+    // Small boxes on a small field, with touching edges common
+    std::srand(7);
+    BoxSet boxes;
+    for (std::size_t i = 0; i < MAX_COUNT; ++i) {
+        boxes.add({ std::rand() % 64 - 8, std::rand() % 64 - 8, 1 + std::rand() % 16, 1 + std::rand() % 16 });
+    }
+    BoxSet queries;
+    for (int i = 0; i < 9; ++i) {
+        queries.add({ std::rand() % 48, std::rand() % 48, 1 + std::rand() % 24, 1 + std::rand() % 24 });
+    }
+    const Rect query = { 20, 20, 16, 16 };
+
+    const aabb::SimdLevel best = aabb::detectSimdLevel();
+    for (int level = aabb::SIMD_SCALAR; level <= best; ++level) {
+        aabb::setSimdLevel(static_cast<aabb::SimdLevel>(level));
+        int before = failures;
+        checkEdges(aabb::simdLevel());
+        checkCounts(aabb::simdLevel(), boxes, query);
+        checkManyVsMany(aabb::simdLevel(), boxes, queries);
+        std::cout << aabb::simdLevelName(aabb::simdLevel()) << ": " << (failures == before ? "ok" : "FAILED") << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+// Benchmark and cross-check for common/csv_map.h.
+//
+// Generates a large CSV map in memory (about 120 MB by default) and parses
+// it with the getline + stringstream + stoi loop blocks_with_a_map.cpp
+// used, then with parseCsvGrid on one thread and on every core. A small
+// map with known bad cells checks the row and column reporting. Exits 1
+// if any result differs.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../csv_map.h"
+
+// The old loader, reading from a string instead of a file
+static std::vector<std::vector<int>> parseOld(const std::string& text) {
+    std::vector<std::vector<int>> mapData;
+    std::istringstream file(text);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::vector<int> row;
+        std::stringstream ss(line);
+        std::string value;
+        while (std::getline(ss, value, ',')) {
+            try {
+                row.push_back(std::stoi(value));
+            } catch (const std::exception&) {
+            }
+        }
+        mapData.push_back(row);
+    }
+    return mapData;
+}
+
+static bool sameTiles(const std::vector<std::vector<int>>& nested, const TileGrid& grid) {
+    if (static_cast<int>(nested.size()) != grid.height()) return false;
+    for (int y = 0; y < grid.height(); ++y) {
+        for (int x = 0; x < grid.width(); ++x) {
+            int expected = x < static_cast<int>(nested[y].size()) ? nested[y][x] : 0;
+            if (grid.at(x, y) != expected) return false;
+        }
+    }
+    return true;
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Bad cells must come back with the right row and column, and the rest of
+// the row must stay in its columns
+static bool checkErrors() {
+    const std::string text = "1,2,3\n4, x ,6\r\n7,8,300,\n\n9,,10\n";
+    TileGrid grid;
+    std::vector<CsvMapError> errors;
+    bool clean = parseCsvGrid(text.data(), text.size(), grid, errors, 2);
+    bool ok = !clean && errors.size() == 3
+              && errors[0].row == 2 && errors[0].column == 2 && errors[0].cell == "x "
+              && errors[1].row == 3 && errors[1].column == 3 && errors[1].cell == "300"
+              && errors[2].row == 5 && errors[2].column == 2
+              && grid.width() == 3 && grid.height() == 5
+              && grid.at(2, 1) == 6 && grid.at(1, 2) == 8 && grid.at(2, 2) == 0 && grid.at(0, 3) == 0 && grid.at(2, 4) == 10;
+    for (const CsvMapError& error : errors) {
+        std::cout << "  row " << error.row << " column " << error.column << ": '" << error.cell << "'" << std::endl;
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int width = argc > 1 ? std::atoi(argv[1]) : 6000;
+    int height = argc > 2 ? std::atoi(argv[2]) : 6000;
+
+    std::string text;
+    text.reserve(static_cast<std::size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (x > 0) text += ',';
+            text += std::to_string(std::rand() % 4 == 0 ? std::rand() % 256 : 0);
+        }
+        text += '\n';
+    }
+    double megabytes = text.size() / (1024.0 * 1024.0);
+    std::cout << "map:               " << width << " x " << height << " cells, " << megabytes << " MB of CSV" << std::endl;
+
+    std::cout << "error reporting:" << std::endl;
+    bool ok = checkErrors();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<int>> nested = parseOld(text);
+    double oldMs = msSince(start);
+    std::cout << "getline + stoi:    " << oldMs << " ms, " << megabytes / oldMs * 1000 << " MB/s" << std::endl;
+
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int threadCounts[] = { 1, cores };
+    for (int threads : threadCounts) {
+        TileGrid grid;
+        std::vector<CsvMapError> errors;
+        start = std::chrono::steady_clock::now();
+        bool clean = parseCsvGrid(text.data(), text.size(), grid, errors, threads);
+        double ms = msSince(start);
+        bool same = clean && sameTiles(nested, grid);
+        ok = ok && same;
+        std::cout << "parseCsvGrid x" << threads << ":" << std::string(threads < 10 ? 4 : 3, ' ') << ms << " ms, "
+                  << megabytes / ms * 1000 << " MB/s (" << oldMs / ms << "x)" << (same ? "" : "  MISMATCH") << std::endl;
+    }
+    std::cout << "cross-check:       " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+// Benchmark and cross-check for common/dirty_rects.h.
+//
+// Moves a handful of 32x32 sprites around a 1920x1080 screen and, each
+// frame, marks their old and new boxes and merges them. Reports how much
+// of the screen is redrawn against a full redraw, and the merge time.
+// Every frame the merged rectangles must cover every marked pixel and
+// must not overlap; exits 1 if they ever do.
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "../dirty_rects.h"
+
+const int SCREEN_WIDTH = 1920;
+const int SCREEN_HEIGHT = 1080;
+const int SPRITE_SIZE = 32;
+
+struct Sprite {
+    DirtyRect box;
+    int dx;
+    int dy;
+};
+
+static void paint(std::vector<std::uint8_t>& pixels, const DirtyRect& rect, bool count) {
+    for (int y = rect.y; y < rect.y + rect.h; ++y) {
+        std::uint8_t* row = pixels.data() + static_cast<std::size_t>(y) * SCREEN_WIDTH;
+        for (int x = rect.x; x < rect.x + rect.w; ++x) {
+            row[x] = count ? row[x] + 1 : 1;
+        }
+    }
+}
+
+// Marked pixels must all be covered, and covered only once
+static bool covers(const std::vector<DirtyRect>& marked, const std::vector<DirtyRect>& merged) {
+    std::vector<std::uint8_t> want(static_cast<std::size_t>(SCREEN_WIDTH) * SCREEN_HEIGHT, 0);
+    std::vector<std::uint8_t> got(want.size(), 0);
+    for (const DirtyRect& rect : marked) paint(want, rect, false);
+    for (const DirtyRect& rect : merged) paint(got, rect, true);
+    for (std::size_t i = 0; i < want.size(); ++i) {
+        if (got[i] > 1 || (want[i] && !got[i])) return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int spriteCount = argc > 1 ? std::atoi(argv[1]) : 12;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 300;
+    // Checking coverage is slow, so only every few frames
+    const int CHECK_EVERY = 10;
+
+    std::vector<Sprite> sprites(spriteCount);
+    for (Sprite& sprite : sprites) {
+        sprite.box = { std::rand() % (SCREEN_WIDTH - SPRITE_SIZE), std::rand() % (SCREEN_HEIGHT - SPRITE_SIZE), SPRITE_SIZE, SPRITE_SIZE };
+        sprite.dx = std::rand() % 9 - 4;
+        sprite.dy = std::rand() % 9 - 4;
+    }
+
+    DirtyRects dirty(SCREEN_WIDTH, SCREEN_HEIGHT);
+    bool ok = true;
+    long long redrawn = 0;
+    long long rects = 0;
+    double mergeNs = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        for (Sprite& sprite : sprites) {
+            DirtyRect old = sprite.box;
+            if (sprite.box.x + sprite.dx < 0 || sprite.box.x + sprite.dx > SCREEN_WIDTH - SPRITE_SIZE) sprite.dx = -sprite.dx;
+            if (sprite.box.y + sprite.dy < 0 || sprite.box.y + sprite.dy > SCREEN_HEIGHT - SPRITE_SIZE) sprite.dy = -sprite.dy;
+            sprite.box.x += sprite.dx;
+            sprite.box.y += sprite.dy;
+            dirty.move(old, sprite.box);
+        }
+        std::vector<DirtyRect> marked = dirty.rects();
+
+        auto start = std::chrono::steady_clock::now();
+        const std::vector<DirtyRect>& merged = dirty.merge();
+        mergeNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        if (frame % CHECK_EVERY == 0 && !covers(marked, merged)) {
+            std::cout << "frame " << frame << ": merged rectangles miss or overlap" << std::endl;
+            ok = false;
+        }
+        redrawn += dirty.totalArea();
+        rects += static_cast<long long>(merged.size());
+        dirty.clear();
+    }
+
+    double screen = static_cast<double>(SCREEN_WIDTH) * SCREEN_HEIGHT;
+    std::cout << "screen:            " << SCREEN_WIDTH << " x " << SCREEN_HEIGHT << ", " << spriteCount << " moving "
+              << SPRITE_SIZE << "x" << SPRITE_SIZE << " sprites, " << frames << " frames" << std::endl;
+    std::cout << "redrawn:           " << 100.0 * redrawn / frames / screen << "% of the screen per frame in "
+              << static_cast<double>(rects) / frames << " rects (" << screen * frames / redrawn << "x fewer pixels)" << std::endl;
+    std::cout << "merge:             " << mergeNs / frames / 1000 << " us/frame" << std::endl;
+    std::cout << "cross-check:       " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+// Benchmark and cross-check for common/level_file.h.
+//
+// Writes one random map both as map.txt-style text and as a level file
+// (100 MB of tiles by default), then times parsing the text against
+// mapping the level file and touching every tile. The mapped scan is
+// reported with the page faults it took. Exits 1 if the two loads
+// disagree on any tile.
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "../level_file.h"
+
+static long minorFaults() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt + usage.ru_majflt;
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    int width = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int height = argc > 2 ? std::atoi(argv[2]) : 10000;
+    const std::string textPath = "release/level_bench.txt";
+    const std::string levelPath = "release/level_bench.lvl";
+
+    // Source map, written both ways
+    {
+        TileGrid grid(width, height);
+        std::ofstream text(textPath);
+        std::string line(width, '0');
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int tile = std::rand() % 4 == 0 ? 1 + std::rand() % 9 : 0;
+                grid.at(x, y) = static_cast<TileGrid::Tile>(tile);
+                line[x] = static_cast<char>('0' + tile);
+            }
+            text << line << '\n';
+        }
+        if (!text || !writeLevel(levelPath, grid)) {
+            std::cerr << "Error writing bench files" << std::endl;
+            return 1;
+        }
+    }
+    double megabytes = static_cast<double>(width) * height / (1024 * 1024);
+    std::cout << "map:               " << width << " x " << height << " tiles, " << megabytes << " MB" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    TileGrid parsed;
+    bool ok = loadDigitGrid(textPath, parsed);
+    double parseMs = msSince(start);
+    std::cout << "text parse:        " << parseMs << " ms, " << megabytes / parseMs * 1000 << " MB/s" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    LevelFile level;
+    ok = level.open(levelPath) && ok;
+    double openMs = msSince(start);
+    TileGridView view = level.layer<std::uint8_t>(0);
+    std::cout << "level open:        " << openMs << " ms" << std::endl;
+
+    // First touch of every page, then again with them all resident
+    long faults = minorFaults();
+    start = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for (auto row : view.rows()) {
+        unsigned rowSum = 0;
+        for (TileGridView::Tile tile : row) rowSum += tile;
+        sum += rowSum;
+    }
+    double coldMs = msSince(start);
+    faults = minorFaults() - faults;
+    start = std::chrono::steady_clock::now();
+    long long warmSum = 0;
+    for (auto row : view.rows()) {
+        unsigned rowSum = 0;
+        for (TileGridView::Tile tile : row) rowSum += tile;
+        warmSum += rowSum;
+    }
+    double warmMs = msSince(start);
+    std::cout << "first scan:        " << coldMs << " ms, " << faults << " page faults" << std::endl;
+    std::cout << "second scan:       " << warmMs << " ms, all pages resident" << std::endl;
+    std::cout << "open + first scan: " << openMs + coldMs << " ms, " << parseMs / (openMs + coldMs) << "x faster than parsing" << std::endl;
+
+    // Same tiles both ways
+    ok = ok && sum == warmSum && view.width() == parsed.width() && view.height() == parsed.height();
+    for (int y = 0; ok && y < view.height(); ++y) {
+        ok = std::equal(view.row(y).begin(), view.row(y).end(), parsed.row(y).begin());
+    }
+    std::cout << "cross-check:       " << (ok ? "ok" : "FAILED") << std::endl;
+
+    level.close();
+    std::remove(textPath.c_str());
+    std::remove(levelPath.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Benchmark and cross-check for common/region_pager.h.
+//
+// Splits a generated level (8192 x 2048 tiles by default) into regions,
+// then pans a screen-sized camera across it, a few tiles a frame with a
+// short sleep standing in for the rest of the frame. Reports the time
+// update() takes on the main thread, how many frames showed a region
+// still loading, and how many regions were resident at most. Every loaded
+// tile in view must match the level, and residency must stay within the
+// limit; exits 1 otherwise.
+#include <unistd.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "../region_pager.h"
+
+const int REGION_SIZE = 128;
+const int MAX_REGIONS = 16;
+const int VIEW_WIDTH = 25;  // tiles, an 800x576 screen of 32-pixel tiles
+const int VIEW_HEIGHT = 18;
+const int PAN_SPEED = 6;    // tiles a frame, far faster than the player runs
+
+static TileGrid::Tile levelTile(int x, int y) {
+    return static_cast<TileGrid::Tile>((x * 7 + y * 13) % 23 < 5 ? 1 + (x + y) % 3 : 0);
+}
+
+int main(int argc, char* argv[]) {
+    int width = argc > 1 ? std::atoi(argv[1]) : 8192;
+    int height = argc > 2 ? std::atoi(argv[2]) : 2048;
+    const std::string dir = "release/region_bench";
+
+    {
+        TileGrid grid(width, height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) grid.at(x, y) = levelTile(x, y);
+        }
+        if (!writeRegions(dir, grid, REGION_SIZE)) {
+            return 1;
+        }
+    }
+    int regionsX = (width + REGION_SIZE - 1) / REGION_SIZE;
+    int regionsY = (height + REGION_SIZE - 1) / REGION_SIZE;
+    std::cout << "level:             " << width << " x " << height << " tiles in " << regionsX * regionsY << " regions of "
+              << REGION_SIZE << ", at most " << MAX_REGIONS << " resident" << std::endl;
+
+    RegionPager pager;
+    const TileGrid::Tile MISSING = 255;
+    if (!pager.open(dir, MAX_REGIONS, MISSING)) {
+        return 1;
+    }
+
+    bool ok = true;
+    int frames = 0;
+    int waitingFrames = 0;
+    int mostResident = 0;
+    double totalUs = 0;
+    double worstUs = 0;
+    int lastY = 0;
+    for (int viewX = 0; viewX + VIEW_WIDTH <= width; viewX += PAN_SPEED, ++frames) {
+        // Drift up and down as well, so vertical prefetch gets used
+        int viewY = static_cast<int>((height - VIEW_HEIGHT) * (0.5 + 0.5 * std::sin(viewX * 0.002)));
+        int directionY = viewY > lastY ? 1 : viewY < lastY ? -1 : 0;
+        lastY = viewY;
+
+        auto start = std::chrono::steady_clock::now();
+        pager.update(viewX, viewY, VIEW_WIDTH, VIEW_HEIGHT, 1, directionY);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        totalUs += us;
+        worstUs = std::max(worstUs, us);
+        mostResident = std::max(mostResident, pager.getResident());
+
+        bool waiting = false;
+        for (int y = viewY; y < viewY + VIEW_HEIGHT; ++y) {
+            for (int x = viewX; x < viewX + VIEW_WIDTH; ++x) {
+                TileGrid::Tile tile = pager.get(x, y);
+                if (tile == MISSING) {
+                    waiting = true;
+                } else if (tile != levelTile(x, y)) {
+                    ok = false;
+                }
+            }
+        }
+        waitingFrames += waiting;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    ok = ok && mostResident <= MAX_REGIONS;
+
+    std::cout << "update:            " << totalUs / frames << " us/frame average, " << worstUs << " us worst" << std::endl;
+    std::cout << "frames:            " << frames << ", " << waitingFrames << " with a region in view still loading" << std::endl;
+    std::cout << "regions:           " << pager.getLoads() << " loaded, " << pager.getEvictions() << " evicted, "
+              << mostResident << " resident at most" << std::endl;
+    std::cout << "cross-check:       " << (ok ? "ok" : "FAILED") << std::endl;
+
+    pager.close();
+    for (int regionY = 0; regionY < regionsY; ++regionY) {
+        for (int regionX = 0; regionX < regionsX; ++regionX) {
+            std::remove(regionPath(dir, regionX, regionY).c_str());
+        }
+    }
+    std::remove((dir + "/" + REGION_INDEX).c_str());
+    rmdir(dir.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+// Benchmark and cross-check for common/tile_grid.h.
+//
+// Builds the same random map as nested vectors (the way the games stored
+// it) and as a TileGrid, then times random lookups, with and without bounds
+// checks, and a full scan counting solid tiles. Every pass must agree with
+// the nested vectors; exits 1 if any differs.
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "../tile_grid.h"
+
+typedef std::vector<std::vector<int>> NestedMap;
+
+// The checked lookup platform-blocktype.cpp did before TileGrid
+static int nestedGet(const NestedMap& map, int x, int y) {
+    if (y >= 0 && y < static_cast<int>(map.size()) && x >= 0 && x < static_cast<int>(map[y].size())) {
+        return map[y][x];
+    }
+    return 0;
+}
+
+template <typename Fn>
+static double timeNs(int reps, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < reps; ++rep) {
+        fn();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / reps;
+}
+
+static bool report(const char* name, double ns, double baseNs, std::size_t count, long long result, long long expected) {
+    bool good = result == expected;
+    std::cout << name << ns / count << " ns/tile (" << baseNs / ns << "x)" << (good ? "" : "  MISMATCH") << std::endl;
+    return good;
+}
+
+int main(int argc, char* argv[]) {
+    int width = argc > 1 ? std::atoi(argv[1]) : 4096;
+    int height = argc > 2 ? std::atoi(argv[2]) : 1024;
+    const std::size_t tiles = static_cast<std::size_t>(width) * height;
+
+    NestedMap nested(height, std::vector<int>(width));
+    TileGrid grid(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int tile = std::rand() % 4 == 0 ? 1 : 0;
+            nested[y][x] = tile;
+            grid.at(x, y) = static_cast<TileGrid::Tile>(tile);
+        }
+    }
+    std::cout << "map:               " << width << " x " << height << " tiles, nested "
+              << tiles * sizeof(int) / 1024 << " KB in " << height << " rows, grid " << tiles / 1024 << " KB" << std::endl;
+
+    // Lookups at random spots, a few of them outside the map
+    const std::size_t lookups = 1 << 22;
+    std::vector<int> xs(lookups);
+    std::vector<int> ys(lookups);
+    for (std::size_t i = 0; i < lookups; ++i) {
+        xs[i] = std::rand() % (width + 8) - 4;
+        ys[i] = std::rand() % (height + 8) - 4;
+    }
+
+    bool ok = true;
+    long long expected = 0;
+    volatile long long sink = 0;
+    std::cout << "random lookup:" << std::endl;
+    double nestedNs = timeNs(5, [&] {
+        long long sum = 0;
+        for (std::size_t i = 0; i < lookups; ++i) sum += nestedGet(nested, xs[i], ys[i]);
+        expected = sum;
+    });
+    std::cout << "  nested checked:   " << nestedNs / lookups << " ns/tile" << std::endl;
+    long long result = 0;
+    double ns = timeNs(5, [&] {
+        long long sum = 0;
+        for (std::size_t i = 0; i < lookups; ++i) sum += grid.get(xs[i], ys[i]);
+        result = sum;
+    });
+    ok = report("  grid get:         ", ns, nestedNs, lookups, result, expected) && ok;
+
+    // Unchecked, on in-bounds spots only
+    for (std::size_t i = 0; i < lookups; ++i) {
+        xs[i] = std::rand() % width;
+        ys[i] = std::rand() % height;
+    }
+    nestedNs = timeNs(5, [&] {
+        long long sum = 0;
+        for (std::size_t i = 0; i < lookups; ++i) sum += nested[ys[i]][xs[i]];
+        expected = sum;
+    });
+    std::cout << "  nested unchecked: " << nestedNs / lookups << " ns/tile" << std::endl;
+    ns = timeNs(5, [&] {
+        long long sum = 0;
+        for (std::size_t i = 0; i < lookups; ++i) sum += grid.at(xs[i], ys[i]);
+        result = sum;
+    });
+    ok = report("  grid at:          ", ns, nestedNs, lookups, result, expected) && ok;
+
+    // Count solid tiles over the whole map
+    std::cout << "full scan:" << std::endl;
+    nestedNs = timeNs(10, [&] {
+        long long solid = 0;
+        for (std::size_t y = 0; y < nested.size(); ++y) {
+            for (std::size_t x = 0; x < nested[y].size(); ++x) solid += nested[y][x] == 1;
+        }
+        expected = solid;
+    });
+    std::cout << "  nested vectors:   " << nestedNs / tiles << " ns/tile" << std::endl;
+    ns = timeNs(10, [&] {
+        long long solid = 0;
+        for (int y = 0; y < grid.height(); ++y) {
+            for (int x = 0; x < grid.width(); ++x) solid += grid.get(x, y) == 1;
+        }
+        result = solid;
+    });
+    ok = report("  grid get:         ", ns, nestedNs, tiles, result, expected) && ok;
+    ns = timeNs(10, [&] {
+        long long solid = 0;
+        for (auto row : grid.rows()) {
+            // Per-row count in a narrow type so the byte compares vectorise
+            unsigned rowSolid = 0;
+            for (TileGrid::Tile tile : row) rowSolid += tile == 1;
+            solid += rowSolid;
+        }
+        result = solid;
+    });
+    ok = report("  grid row spans:   ", ns, nestedNs, tiles, result, expected) && ok;
+
+    sink = result;
+    (void)sink;
+    return ok ? 0 : 1;
+}
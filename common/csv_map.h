@@ -0,0 +1,253 @@
+#ifndef CSV_MAP_H
+#define CSV_MAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tile_grid.h"
+
+// Parallel reader for CSV tile maps: one row per line, comma-separated
+// tile numbers, optional spaces around them and an optional trailing
+// comma.
+//
+// The text is cut into line-aligned chunks which worker threads take in
+// turn. Each chunk is scanned with a hand-written integer parser into its
+// own tile buffer; once every chunk is done the row counts give each one
+// its first row and the buffers are copied into the grid, again in
+// parallel. Bad cells (not a number, or too big for the tile type) become
+// 0 and are reported with their 1-based row and column. Short rows are
+// padded with 0. Header only; link with -pthread.
+
+struct CsvMapError {
+    int row;
+    int column;
+    std::string cell;
+};
+
+// At most this many errors are kept; the count is still exact
+const std::size_t CSV_MAP_MAX_ERRORS = 100;
+
+namespace csvmap {
+
+// One line-aligned piece of the input and what was parsed from it
+template <typename T>
+struct Chunk {
+    const char* begin;
+    const char* end;
+    std::vector<T> tiles;
+    std::vector<std::size_t> rowEnds; // end of each row in tiles
+    std::vector<CsvMapError> errors;  // rows relative to the chunk
+    std::size_t errorCount = 0;
+    std::size_t width = 0;
+    int firstRow = 0;
+};
+
+inline bool isBlank(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+template <typename T>
+void parseChunk(Chunk<T>& chunk) {
+    const unsigned maxTile = sizeof(T) == 1 ? 0xff : 0xffff;
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+    // Every cell takes at least one byte, its comma or newline, so this
+    // never runs out and the loop writes through a plain pointer
+    chunk.tiles.resize(end - p + 1);
+    T* base = chunk.tiles.data();
+    T* out = base;
+    T* rowStart = out;
+    int row = 0;
+    int column = 0;
+
+    auto endRow = [&] {
+        chunk.rowEnds.push_back(out - base);
+        chunk.width = std::max(chunk.width, static_cast<std::size_t>(out - rowStart));
+        rowStart = out;
+        ++row;
+        column = 0;
+    };
+
+    while (p < end) {
+        // Fast path: one to three digits then a comma or newline, which is
+        // nearly every cell. The digit count is worked out without
+        // branching on it, so short and long numbers cost the same.
+        if (end - p >= 4) {
+            unsigned d0 = static_cast<unsigned char>(p[0]) - '0';
+            unsigned d1 = static_cast<unsigned char>(p[1]) - '0';
+            unsigned d2 = static_cast<unsigned char>(p[2]) - '0';
+            unsigned two = d1 < 10;
+            unsigned three = two & (d2 < 10);
+            unsigned length = 1 + two + three;
+            char separator = p[length];
+            unsigned value = three ? d0 * 100 + d1 * 10 + d2 : two ? d0 * 10 + d1 : d0;
+            if (d0 < 10 && (separator == ',' || separator == '\n') && value <= maxTile) {
+                *out++ = static_cast<T>(value);
+                ++column;
+                p += length + 1;
+                if (separator == '\n') {
+                    endRow();
+                }
+                continue;
+            }
+        }
+
+        // Everything else, a cell at a time: blanks, longer numbers, bad
+        // cells, blank lines and trailing commas
+        const char* q = p;
+        while (q < end && isBlank(*q)) ++q;
+        if (q == end || *q == '\n') {
+            endRow();
+            p = q == end ? end : q + 1;
+            continue;
+        }
+        const char* cell = q;
+        unsigned value = 0;
+        unsigned digit;
+        while (q < end && (digit = static_cast<unsigned char>(*q) - '0') < 10) {
+            value = value * 10 + digit;
+            value = value > maxTile ? maxTile + 1 : value; // stays too big, never wraps
+            ++q;
+        }
+        bool bad = q == cell || value > maxTile;
+        while (q < end && isBlank(*q)) ++q;
+        if (q < end && *q != ',' && *q != '\n') {
+            bad = true;
+            while (q < end && *q != ',' && *q != '\n') ++q;
+        }
+        if (bad) {
+            if (chunk.errors.size() < CSV_MAP_MAX_ERRORS) {
+                chunk.errors.push_back({ row, column, std::string(cell, q) });
+            }
+            ++chunk.errorCount;
+            value = 0;
+        }
+        *out++ = static_cast<T>(value);
+        ++column;
+        if (q == end || *q == '\n') {
+            endRow();
+            p = q == end ? end : q + 1;
+        } else {
+            p = q + 1;
+        }
+    }
+    // A last row cut short by the end of the text after a comma
+    if (column > 0) {
+        endRow();
+    }
+    chunk.tiles.resize(out - base);
+}
+
+} // namespace csvmap
+
+// Parses size bytes of CSV text into grid. threads 0 means one per core.
+// Returns true if every cell was good; errors gets the bad ones either way.
+template <typename T>
+bool parseCsvGrid(const char* text, std::size_t size, TileGridT<T>& grid, std::vector<CsvMapError>& errors, int threads = 0) {
+    errors.clear();
+    if (threads <= 0) {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    // A few chunks per thread so an uneven chunk does not hold up the rest,
+    // but none so small that the split costs more than it saves
+    const std::size_t MIN_CHUNK = 256 * 1024;
+    std::size_t chunkCount = std::max<std::size_t>(1, std::min<std::size_t>(threads * 4, size / MIN_CHUNK));
+    std::vector<csvmap::Chunk<T>> chunks;
+    const char* end = text + size;
+    const char* p = text;
+    for (std::size_t i = 0; i < chunkCount && p < end; ++i) {
+        const char* cut = i + 1 == chunkCount ? end : text + size / chunkCount * (i + 1);
+        if (cut < p) cut = p;
+        const char* newline = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+        const char* chunkEnd = newline ? newline + 1 : end;
+        csvmap::Chunk<T> chunk;
+        chunk.begin = p;
+        chunk.end = chunkEnd;
+        chunks.push_back(std::move(chunk));
+        p = chunkEnd;
+    }
+
+    // Runs fn(chunk) on every chunk across the worker threads
+    auto forEachChunk = [&](auto fn) {
+        std::atomic<std::size_t> next(0);
+        auto work = [&] {
+            for (std::size_t i = next++; i < chunks.size(); i = next++) {
+                fn(chunks[i]);
+            }
+        };
+        int workers = std::min<int>(threads, static_cast<int>(chunks.size()));
+        std::vector<std::thread> pool;
+        for (int t = 1; t < workers; ++t) {
+            pool.emplace_back(work);
+        }
+        work();
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+    };
+
+    forEachChunk([](csvmap::Chunk<T>& chunk) { csvmap::parseChunk(chunk); });
+
+    int height = 0;
+    std::size_t width = 0;
+    std::size_t errorCount = 0;
+    for (csvmap::Chunk<T>& chunk : chunks) {
+        chunk.firstRow = height;
+        height += static_cast<int>(chunk.rowEnds.size());
+        width = std::max(width, chunk.width);
+        errorCount += chunk.errorCount;
+        for (const CsvMapError& error : chunk.errors) {
+            if (errors.size() < CSV_MAP_MAX_ERRORS) {
+                errors.push_back({ chunk.firstRow + error.row + 1, error.column + 1, error.cell });
+            }
+        }
+    }
+
+    grid.resize(static_cast<int>(width), height);
+    forEachChunk([&grid](csvmap::Chunk<T>& chunk) {
+        std::size_t start = 0;
+        for (std::size_t r = 0; r < chunk.rowEnds.size(); ++r) {
+            std::copy(chunk.tiles.begin() + start, chunk.tiles.begin() + chunk.rowEnds[r],
+                      grid.row(chunk.firstRow + static_cast<int>(r)).begin());
+            start = chunk.rowEnds[r];
+        }
+        std::vector<T>().swap(chunk.tiles);
+    });
+
+    if (errorCount > errors.size()) {
+        std::cerr << errorCount << " bad cells in CSV map, first " << errors.size() << " kept" << std::endl;
+    }
+    return errorCount == 0;
+}
+
+// Reads and parses a CSV map file. Returns false if it cannot be read or
+// has bad cells.
+template <typename T>
+bool loadCsvGrid(const std::string& path, TileGridT<T>& grid, std::vector<CsvMapError>& errors, int threads = 0) {
+    errors.clear();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Error opening map file: " << path << std::endl;
+        return false;
+    }
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    std::vector<char> text(size > 0 ? size : 0);
+    std::size_t got = std::fread(text.data(), 1, text.size(), file);
+    std::fclose(file);
+    if (size < 0 || got != text.size()) {
+        std::cerr << "Error reading map file: " << path << std::endl;
+        return false;
+    }
+    return parseCsvGrid(text.data(), text.size(), grid, errors, threads);
+}
+
+#endif // CSV_MAP_H
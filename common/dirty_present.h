@@ -0,0 +1,100 @@
+#ifndef DIRTY_PRESENT_H
+#define DIRTY_PRESENT_H
+
+#include <iostream>
+#include <vector>
+#include "dirty_rects.h"
+
+// Presents a frame by redrawing only its dirty rectangles.
+//
+// The frame lives in a render-target texture. present() merges the
+// DirtyRects, redraws each rectangle into the texture with the clip rect
+// set to it, copies the texture to the window and presents; with nothing
+// dirty it does nothing at all. The software renderer keeps the window's
+// pixels between frames, so with it only the dirty rectangles are copied;
+// other renderers get the whole texture, since their back buffer is
+// undefined after a present. If the texture cannot be created every
+// frame is drawn in full, straight to the window.
+//
+// Uses the SDL2 API and is SDL's only user in common/. It does not include
+// SDL itself, since the demos reach it as <SDL.h> or <SDL2/SDL.h>: include
+// SDL first.
+
+class DirtyPresenter {
+public:
+    DirtyPresenter(SDL_Renderer* renderer, int width, int height)
+        : mRenderer(renderer), mFrame(nullptr), mPartialCopy(false), mDirty(width, height) {
+        mFrame = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (mFrame) {
+            SDL_SetTextureBlendMode(mFrame, SDL_BLENDMODE_NONE);
+        } else {
+            std::cerr << "Error creating frame texture, redrawing every frame: " << SDL_GetError() << std::endl;
+        }
+        SDL_RendererInfo info;
+        mPartialCopy = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_SOFTWARE);
+        mDirty.markAll();
+    }
+    ~DirtyPresenter() { close(); }
+
+    DirtyPresenter(const DirtyPresenter&) = delete;
+    DirtyPresenter& operator=(const DirtyPresenter&) = delete;
+
+    // Frees the frame texture; call before destroying the renderer
+    void close() {
+        if (mFrame) {
+            SDL_DestroyTexture(mFrame);
+            mFrame = nullptr;
+        }
+    }
+
+    DirtyRects& dirty() { return mDirty; }
+
+    // Window events (uncovered, resized) and lost render targets mean
+    // everything needs drawing again
+    void handleEvent(const SDL_Event& event) {
+        if (event.type == SDL_WINDOWEVENT || event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+            mDirty.markAll();
+        }
+    }
+
+    // Calls draw(area) for each dirty SDL_Rect, clip rect already set,
+    // then presents. Does nothing if nothing is dirty.
+    template <typename Draw>
+    void present(Draw draw) {
+        if (!mFrame) {
+            mDirty.markAll();
+        }
+        if (mDirty.empty()) {
+            return;
+        }
+        const std::vector<DirtyRect>& rects = mDirty.merge();
+        SDL_SetRenderTarget(mRenderer, mFrame);
+        for (const DirtyRect& rect : rects) {
+            SDL_Rect area = { rect.x, rect.y, rect.w, rect.h };
+            SDL_RenderSetClipRect(mRenderer, &area);
+            draw(area);
+        }
+        SDL_RenderSetClipRect(mRenderer, nullptr);
+        if (mFrame) {
+            SDL_SetRenderTarget(mRenderer, nullptr);
+            if (mPartialCopy) {
+                for (const DirtyRect& rect : rects) {
+                    SDL_Rect area = { rect.x, rect.y, rect.w, rect.h };
+                    SDL_RenderCopy(mRenderer, mFrame, &area, &area);
+                }
+            } else {
+                SDL_RenderCopy(mRenderer, mFrame, nullptr, nullptr);
+            }
+        }
+        SDL_RenderPresent(mRenderer);
+        mDirty.clear();
+    }
+
+private:
+    SDL_Renderer* mRenderer;
+    SDL_Texture* mFrame;
+    bool mPartialCopy;
+    DirtyRects mDirty;
+};
+
+#endif // DIRTY_PRESENT_H
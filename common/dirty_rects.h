@@ -0,0 +1,136 @@
+#ifndef DIRTY_RECTS_H
+#define DIRTY_RECTS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Tracks which parts of the screen need redrawing.
+//
+// Each frame, whatever changed reports its bounds: a moving thing its old
+// and new box, a HUD element the box it redraws. merge() then joins boxes
+// that overlap, or that sit so close that one box covering both wastes
+// little, into a short list of non-overlapping rectangles to redraw. If
+// those would cover most of the screen anyway it returns the whole screen
+// as one. An empty list means nothing changed and the frame can be
+// skipped.
+//
+// Games keep the frame in a render-target texture, redraw only the merged
+// rectangles into it (with the clip rect set to each), and copy it to the
+// window. Header only; rectangles have the same layout as SDL_Rect.
+
+struct DirtyRect {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+class DirtyRects {
+public:
+    // Two boxes are joined when the box around both is at most this many
+    // pixels bigger than the two together
+    static const long long MERGE_SLACK = 64 * 64;
+    // Past this many rectangles, or this share of the screen, the whole
+    // screen is redrawn instead
+    static const std::size_t MAX_RECTS = 128;
+    static constexpr double FULL_SHARE = 0.6;
+
+    DirtyRects(int width, int height) : mWidth(width), mHeight(height) {}
+
+    // The screen changed size; everything needs drawing again
+    void resize(int width, int height) {
+        mWidth = width;
+        mHeight = height;
+        markAll();
+    }
+
+    // Marks an area, clipped to the screen
+    void add(int x, int y, int w, int h) {
+        int left = std::max(x, 0);
+        int top = std::max(y, 0);
+        int right = std::min(x + w, mWidth);
+        int bottom = std::min(y + h, mHeight);
+        if (right > left && bottom > top) {
+            mRects.push_back({ left, top, right - left, bottom - top });
+        }
+    }
+    void add(const DirtyRect& rect) { add(rect.x, rect.y, rect.w, rect.h); }
+
+    // Something moved from one box to another. Nothing is marked if it did
+    // not move.
+    void move(const DirtyRect& from, const DirtyRect& to) {
+        if (from.x == to.x && from.y == to.y && from.w == to.w && from.h == to.h) {
+            return;
+        }
+        add(from);
+        add(to);
+    }
+
+    // The whole screen, e.g. on the first frame or after the window was exposed
+    void markAll() {
+        mRects.clear();
+        add(0, 0, mWidth, mHeight);
+    }
+
+    bool empty() const { return mRects.empty(); }
+    void clear() { mRects.clear(); }
+
+    // Joins the marked rectangles and returns them, none overlapping
+    const std::vector<DirtyRect>& merge() {
+        bool joined = true;
+        while (joined) {
+            joined = false;
+            for (std::size_t i = 0; i < mRects.size(); ++i) {
+                for (std::size_t j = i + 1; j < mRects.size(); ++j) {
+                    DirtyRect around = bounds(mRects[i], mRects[j]);
+                    if (overlaps(mRects[i], mRects[j]) || area(around) <= area(mRects[i]) + area(mRects[j]) + MERGE_SLACK) {
+                        mRects[i] = around;
+                        mRects[j] = mRects.back();
+                        mRects.pop_back();
+                        joined = true;
+                        --j;
+                    }
+                }
+            }
+        }
+        if (mRects.size() > MAX_RECTS || totalArea() > FULL_SHARE * mWidth * mHeight) {
+            markAll();
+        }
+        return mRects;
+    }
+
+    const std::vector<DirtyRect>& rects() const { return mRects; }
+
+    // Pixels covered; exact after merge()
+    long long totalArea() const {
+        long long total = 0;
+        for (const DirtyRect& rect : mRects) {
+            total += area(rect);
+        }
+        return total;
+    }
+
+    static long long area(const DirtyRect& rect) {
+        return static_cast<long long>(rect.w) * rect.h;
+    }
+
+    static bool overlaps(const DirtyRect& a, const DirtyRect& b) {
+        return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+    }
+
+private:
+    int mWidth;
+    int mHeight;
+    std::vector<DirtyRect> mRects;
+
+    static DirtyRect bounds(const DirtyRect& a, const DirtyRect& b) {
+        int left = std::min(a.x, b.x);
+        int top = std::min(a.y, b.y);
+        int right = std::max(a.x + a.w, b.x + b.w);
+        int bottom = std::max(a.y + a.h, b.y + b.h);
+        return { left, top, right - left, bottom - top };
+    }
+};
+
+#endif // DIRTY_RECTS_H
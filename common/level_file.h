@@ -0,0 +1,221 @@
+#ifndef LEVEL_FILE_H
+#define LEVEL_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "tile_grid.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Binary level files.
+//
+// Layout, in host byte order (little-endian on everything the games
+// build for):
+//   32-byte header: "TLVL", u32 version, u32 width, u32 height,
+//                   u32 layer count, u32 bytes per tile (1 or 2), 8 reserved
+//   payload:        each layer in turn, width * height tiles, row by row
+//
+// LevelFile maps the file into memory and hands out TileGridViews that
+// point straight into the mapping, so opening a level reads only the
+// header; tiles are paged in as they are touched. Platforms without mmap
+// read the whole file instead. writeLevel() writes a file from grids.
+// Header only.
+
+struct LevelHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t layers;
+    std::uint32_t tileBytes;
+    std::uint32_t reserved[2];
+};
+
+const char LEVEL_MAGIC[4] = { 'T', 'L', 'V', 'L' };
+const std::uint32_t LEVEL_VERSION = 1;
+
+class LevelFile {
+public:
+    LevelFile() : mBase(nullptr), mSize(0), mMapped(false) {
+        std::memset(&mHeader, 0, sizeof(mHeader));
+    }
+    ~LevelFile() { close(); }
+
+    LevelFile(const LevelFile&) = delete;
+    LevelFile& operator=(const LevelFile&) = delete;
+
+    // Maps the file and checks the header and size. Returns false, with a
+    // message on std::cerr, if it is missing or malformed.
+    bool open(const std::string& path) {
+        close();
+        if (!mapFile(path)) {
+            return false;
+        }
+        if (mSize < sizeof(LevelHeader)) {
+            std::cerr << "Level file too short: " << path << std::endl;
+            close();
+            return false;
+        }
+        std::memcpy(&mHeader, mBase, sizeof(mHeader));
+        if (std::memcmp(mHeader.magic, LEVEL_MAGIC, 4) != 0 || mHeader.version != LEVEL_VERSION) {
+            std::cerr << "Not a version " << LEVEL_VERSION << " level file: " << path << std::endl;
+            close();
+            return false;
+        }
+        if ((mHeader.tileBytes != 1 && mHeader.tileBytes != 2) || mHeader.width > 0x7fffffff || mHeader.height > 0x7fffffff) {
+            std::cerr << "Bad level dimensions in " << path << std::endl;
+            close();
+            return false;
+        }
+        // Divided rather than multiplied so a corrupt header cannot overflow
+        std::size_t payload = mSize - sizeof(LevelHeader);
+        std::size_t rowBytes = static_cast<std::size_t>(mHeader.width) * mHeader.tileBytes;
+        if (mHeader.layers > 0 && rowBytes > 0 && mHeader.height > payload / rowBytes / mHeader.layers) {
+            std::cerr << "Level file truncated: " << path << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (mMapped) {
+            munmap(const_cast<char*>(mBase), mSize);
+        }
+#endif
+        mBuffer.clear();
+        mBase = nullptr;
+        mSize = 0;
+        mMapped = false;
+        std::memset(&mHeader, 0, sizeof(mHeader));
+    }
+
+    bool isOpen() const { return mBase != nullptr; }
+    int width() const { return static_cast<int>(mHeader.width); }
+    int height() const { return static_cast<int>(mHeader.height); }
+    int layers() const { return static_cast<int>(mHeader.layers); }
+    int tileBytes() const { return static_cast<int>(mHeader.tileBytes); }
+
+    // Layer i as a view into the file. Empty if i is out of range or the
+    // file's tiles are not sizeof(T) bytes.
+    template <typename T>
+    TileGridViewT<T> layer(int i) const {
+        if (!isOpen() || i < 0 || i >= layers() || sizeof(T) != mHeader.tileBytes) {
+            return TileGridViewT<T>();
+        }
+        const char* tiles = mBase + sizeof(LevelHeader) + layerBytes() * i;
+        return TileGridViewT<T>(reinterpret_cast<const T*>(tiles), width(), height(), width());
+    }
+
+private:
+    const char* mBase;
+    std::size_t mSize;
+    bool mMapped;
+    std::vector<char> mBuffer;
+    LevelHeader mHeader;
+
+    std::size_t layerBytes() const {
+        return static_cast<std::size_t>(mHeader.width) * mHeader.height * mHeader.tileBytes;
+    }
+
+    bool mapFile(const std::string& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error opening level file: " << path << std::endl;
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            std::cerr << "Error reading level file: " << path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        void* base = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            std::cerr << "Error mapping level file: " << path << std::endl;
+            return false;
+        }
+        mBase = static_cast<const char*>(base);
+        mSize = info.st_size;
+        mMapped = true;
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error opening level file: " << path << std::endl;
+            return false;
+        }
+        mBuffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (mBuffer.empty()) {
+            std::cerr << "Error reading level file: " << path << std::endl;
+            return false;
+        }
+        mBase = mBuffer.data();
+        mSize = mBuffer.size();
+        return true;
+#endif
+    }
+};
+
+// Whether path names a level file rather than a text map
+inline bool isLevelFile(const std::string& path) {
+    return path.size() > 4 && path.compare(path.size() - 4, 4, ".lvl") == 0;
+}
+
+// Writes the grids as the layers of one level file. All of them must be
+// the same size. Returns false, with a message on std::cerr, on failure.
+template <typename T>
+bool writeLevel(const std::string& path, const std::vector<const TileGridT<T>*>& layers) {
+    if (layers.empty()) {
+        std::cerr << "No layers to write to " << path << std::endl;
+        return false;
+    }
+    for (const TileGridT<T>* grid : layers) {
+        if (grid->width() != layers[0]->width() || grid->height() != layers[0]->height()) {
+            std::cerr << "Level layers differ in size: " << path << std::endl;
+            return false;
+        }
+    }
+
+    LevelHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, LEVEL_MAGIC, 4);
+    header.version = LEVEL_VERSION;
+    header.width = layers[0]->width();
+    header.height = layers[0]->height();
+    header.layers = static_cast<std::uint32_t>(layers.size());
+    header.tileBytes = sizeof(T);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const TileGridT<T>* grid : layers) {
+        file.write(reinterpret_cast<const char*>(grid->data()),
+                   static_cast<std::streamsize>(grid->width()) * grid->height() * sizeof(T));
+    }
+    if (!file) {
+        std::cerr << "Error writing level file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool writeLevel(const std::string& path, const TileGridT<T>& grid) {
+    return writeLevel(path, std::vector<const TileGridT<T>*>(1, &grid));
+}
+
+#endif // LEVEL_FILE_H
@@ -0,0 +1,364 @@
+#ifndef REGION_PAGER_H
+#define REGION_PAGER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "level_file.h"
+#include "tile_grid.h"
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#else
+#include <direct.h>
+#endif
+
+// Levels too big to hold in memory, paged in a region at a time.
+//
+// A region level is a directory holding regions.txt ("width height
+// regionSize", all in tiles) and one level file per region,
+// r<regionX>_<regionY>.lvl, regionSize tiles square except along the
+// right and bottom edges of the level.
+//
+// RegionPager keeps at most maxRegions regions in memory. Once a frame,
+// update() is told what the camera sees and which way it is moving; it
+// queues the regions in view, then the ones a region ahead, for a loader
+// thread, and once over the limit drops the loaded regions furthest from
+// the view. The main thread never waits on the disk: the queue and the
+// finished regions are swapped under a lock, and tiles of a region still
+// loading read as the missing tile. Header only; link with -pthread.
+
+const char REGION_INDEX[] = "regions.txt";
+
+// Region sides are a multiple of this, the side of a ChunkCache chunk in
+// platform_scroller, so no chunk straddles two regions
+const int REGION_ALIGN = 16;
+
+inline bool checkRegionSize(int regionSize) {
+    if (regionSize <= 0 || regionSize % REGION_ALIGN != 0) {
+        std::cerr << "Region size must be a multiple of " << REGION_ALIGN << std::endl;
+        return false;
+    }
+    return true;
+}
+
+inline std::string regionPath(const std::string& dir, int regionX, int regionY) {
+    return dir + "/r" + std::to_string(regionX) + "_" + std::to_string(regionY) + ".lvl";
+}
+
+// Whether dir is a region level rather than a single map file
+inline bool isRegionLevel(const std::string& dir) {
+    std::ifstream index(dir + "/" + REGION_INDEX);
+    return index.good();
+}
+
+// Creates dir if it is not there yet
+inline bool makeDirectory(const std::string& dir) {
+#ifndef _WIN32
+    int result = mkdir(dir.c_str(), 0755);
+#else
+    int result = _mkdir(dir.c_str());
+#endif
+    struct stat info;
+    if (result != 0 && (stat(dir.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR))) {
+        std::cerr << "Error creating directory: " << dir << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Writes regions.txt for a level of width x height tiles
+inline bool writeRegionIndex(const std::string& dir, int width, int height, int regionSize) {
+    std::ofstream index(dir + "/" + REGION_INDEX);
+    index << width << " " << height << " " << regionSize << "\n";
+    if (!index) {
+        std::cerr << "Error writing region index in " << dir << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Splits grid into a region level in dir
+template <typename T>
+bool writeRegions(const std::string& dir, const TileGridT<T>& grid, int regionSize) {
+    if (!checkRegionSize(regionSize) || !makeDirectory(dir) || !writeRegionIndex(dir, grid.width(), grid.height(), regionSize)) {
+        return false;
+    }
+    TileGridT<T> region;
+    for (int regionY = 0; regionY * regionSize < grid.height(); ++regionY) {
+        for (int regionX = 0; regionX * regionSize < grid.width(); ++regionX) {
+            int firstX = regionX * regionSize;
+            int firstY = regionY * regionSize;
+            region.resize(std::min(regionSize, grid.width() - firstX), std::min(regionSize, grid.height() - firstY));
+            for (int y = 0; y < region.height(); ++y) {
+                TileRow<const T> source = grid.row(firstY + y);
+                std::copy(source.begin() + firstX, source.begin() + firstX + region.width(), region.row(y).begin());
+            }
+            if (!writeLevel(regionPath(dir, regionX, regionY), region)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+class RegionPager {
+public:
+    RegionPager()
+        : mWidth(0), mHeight(0), mRegionSize(0), mMaxRegions(0), mMissingTile(0), mStop(false), mLoading(NO_REGION),
+          mLoads(0), mEvictions(0), mLastKey(NO_REGION), mLast(nullptr) {}
+    ~RegionPager() { close(); }
+
+    RegionPager(const RegionPager&) = delete;
+    RegionPager& operator=(const RegionPager&) = delete;
+
+    // Reads the level's index and starts the loader thread. Tiles not
+    // loaded yet read as missingTile. Returns false, with a message on
+    // std::cerr, if the index is missing or malformed or its region size
+    // is not a multiple of REGION_ALIGN.
+    bool open(const std::string& dir, int maxRegions, std::uint8_t missingTile) {
+        close();
+        std::ifstream index(dir + "/" + REGION_INDEX);
+        if (!(index >> mWidth >> mHeight >> mRegionSize) || mWidth <= 0 || mHeight <= 0 || mRegionSize <= 0) {
+            std::cerr << "Bad or missing region index in " << dir << std::endl;
+            mWidth = mHeight = mRegionSize = 0;
+            return false;
+        }
+        if (!checkRegionSize(mRegionSize)) {
+            std::cerr << "Bad region index in " << dir << std::endl;
+            mWidth = mHeight = mRegionSize = 0;
+            return false;
+        }
+        mDir = dir;
+        mMaxRegions = maxRegions;
+        mMissingTile = missingTile;
+        mStop = false;
+        mLoader = std::thread(&RegionPager::loaderLoop, this);
+        return true;
+    }
+
+    // Stops the loader, after the region it is on, and drops every region
+    void close() {
+        if (mLoader.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStop = true;
+            }
+            mWake.notify_one();
+            mLoader.join();
+        }
+        mQueue.clear();
+        mDone.clear();
+        mRegions.clear();
+        mLoading = NO_REGION;
+        mLastKey = NO_REGION;
+        mLast = nullptr;
+    }
+
+    int width() const { return mWidth; }
+    int height() const { return mHeight; }
+    int regionSize() const { return mRegionSize; }
+
+    // Call once a frame with the camera's view, in tiles, and the way it
+    // is moving: -1, 0 or 1 on each axis
+    void update(int viewX, int viewY, int viewWidth, int viewHeight, int directionX, int directionY) {
+        if (mRegionSize == 0) {
+            return;
+        }
+        // Regions in view, then the ones a region ahead
+        int firstX = regionOf(viewX, mWidth);
+        int firstY = regionOf(viewY, mHeight);
+        int lastX = regionOf(viewX + viewWidth - 1, mWidth);
+        int lastY = regionOf(viewY + viewHeight - 1, mHeight);
+        int aheadFirstX = regionOf(viewX + (directionX < 0 ? -mRegionSize : 0), mWidth);
+        int aheadFirstY = regionOf(viewY + (directionY < 0 ? -mRegionSize : 0), mHeight);
+        int aheadLastX = regionOf(viewX + viewWidth - 1 + (directionX > 0 ? mRegionSize : 0), mWidth);
+        int aheadLastY = regionOf(viewY + viewHeight - 1 + (directionY > 0 ? mRegionSize : 0), mHeight);
+
+        std::vector<long long> wanted;
+        for (int regionY = aheadFirstY; regionY <= aheadLastY; ++regionY) {
+            for (int regionX = aheadFirstX; regionX <= aheadLastX; ++regionX) {
+                bool inView = regionX >= firstX && regionX <= lastX && regionY >= firstY && regionY <= lastY;
+                if (inView) {
+                    wanted.insert(wanted.begin(), makeKey(regionX, regionY));
+                } else {
+                    wanted.push_back(makeKey(regionX, regionY));
+                }
+            }
+        }
+
+        // Swap in what the loader finished and hand it the new queue; the
+        // old queue is dropped, so regions the camera turned away from
+        // before they were reached are never read
+        std::vector<std::pair<long long, TileGrid>> done;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            done.swap(mDone);
+            mQueue.clear();
+            for (long long key : wanted) {
+                if (key != mLoading && mRegions.find(key) == mRegions.end()) {
+                    bool finished = false;
+                    for (const auto& region : done) {
+                        finished = finished || region.first == key;
+                    }
+                    if (!finished) {
+                        mQueue.push_back(key);
+                    }
+                }
+            }
+        }
+        mWake.notify_one();
+        for (auto& region : done) {
+            mRegions[region.first] = std::move(region.second);
+            ++mLoads;
+        }
+
+        // Over the limit: drop the furthest regions not wanted this frame
+        int centerX = (firstX + lastX) / 2;
+        int centerY = (firstY + lastY) / 2;
+        while (static_cast<int>(mRegions.size()) > mMaxRegions) {
+            auto furthest = mRegions.end();
+            int furthestDistance = -1;
+            for (auto it = mRegions.begin(); it != mRegions.end(); ++it) {
+                int regionX = keyX(it->first);
+                int regionY = keyY(it->first);
+                if (regionX >= aheadFirstX && regionX <= aheadLastX && regionY >= aheadFirstY && regionY <= aheadLastY) {
+                    continue;
+                }
+                int distance = std::max(std::abs(regionX - centerX), std::abs(regionY - centerY));
+                if (distance > furthestDistance) {
+                    furthestDistance = distance;
+                    furthest = it;
+                }
+            }
+            if (furthest == mRegions.end()) {
+                break;
+            }
+            mRegions.erase(furthest);
+            ++mEvictions;
+            mLastKey = NO_REGION;
+            mLast = nullptr;
+        }
+    }
+
+    // Tile (x, y): 0 outside the level, the missing tile while its region loads
+    std::uint8_t get(int x, int y) const {
+        if (static_cast<unsigned>(x) >= static_cast<unsigned>(mWidth) || static_cast<unsigned>(y) >= static_cast<unsigned>(mHeight)) {
+            return 0;
+        }
+        int localX;
+        int localY;
+        const TileGrid* tiles = region(x, y, localX, localY);
+        return tiles ? tiles->at(localX, localY) : mMissingTile;
+    }
+
+    // The loaded region holding tile (x, y), inside the level, and where
+    // the tile is in it. Null while the region is still loading.
+    const TileGrid* region(int x, int y, int& localX, int& localY) const {
+        int regionX = x / mRegionSize;
+        int regionY = y / mRegionSize;
+        localX = x - regionX * mRegionSize;
+        localY = y - regionY * mRegionSize;
+        long long key = makeKey(regionX, regionY);
+        if (key != mLastKey) {
+            auto found = mRegions.find(key);
+            if (found == mRegions.end()) {
+                return nullptr;
+            }
+            mLastKey = key;
+            mLast = &found->second;
+        }
+        return mLast;
+    }
+
+    int getLoads() const { return mLoads; }
+    int getEvictions() const { return mEvictions; }
+    int getResident() const { return static_cast<int>(mRegions.size()); }
+
+private:
+    static const long long NO_REGION = -1;
+
+    std::string mDir;
+    int mWidth;
+    int mHeight;
+    int mRegionSize;
+    int mMaxRegions;
+    std::uint8_t mMissingTile;
+    std::unordered_map<long long, TileGrid> mRegions;
+
+    // Shared with the loader thread, under mMutex
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::deque<long long> mQueue;
+    std::vector<std::pair<long long, TileGrid>> mDone;
+    bool mStop;
+    long long mLoading;
+    std::thread mLoader;
+
+    int mLoads;
+    int mEvictions;
+    // Region of the last lookup
+    mutable long long mLastKey;
+    mutable const TileGrid* mLast;
+
+    static long long makeKey(int regionX, int regionY) {
+        return (static_cast<long long>(regionY) << 32) | static_cast<unsigned int>(regionX);
+    }
+    static int keyX(long long key) { return static_cast<int>(key & 0xffffffff); }
+    static int keyY(long long key) { return static_cast<int>(key >> 32); }
+
+    // Region holding tile, clamped to the level
+    int regionOf(int tile, int size) const {
+        return std::min(std::max(tile, 0), size - 1) / mRegionSize;
+    }
+
+    void loaderLoop() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true) {
+            mWake.wait(lock, [this] { return mStop || !mQueue.empty(); });
+            if (mStop) {
+                return;
+            }
+            long long key = mQueue.front();
+            mQueue.pop_front();
+            mLoading = key;
+            lock.unlock();
+
+            TileGrid tiles;
+            loadRegion(keyX(key), keyY(key), tiles);
+
+            lock.lock();
+            mDone.emplace_back(key, std::move(tiles));
+            mLoading = NO_REGION;
+        }
+    }
+
+    // Runs on the loader thread. A missing or bad region file loads as
+    // empty tiles so the level stays playable.
+    void loadRegion(int regionX, int regionY, TileGrid& tiles) const {
+        int width = std::min(mRegionSize, mWidth - regionX * mRegionSize);
+        int height = std::min(mRegionSize, mHeight - regionY * mRegionSize);
+        LevelFile level;
+        if (level.open(regionPath(mDir, regionX, regionY))) {
+            TileGridView layer = level.layer<TileGrid::Tile>(0);
+            if (layer.width() == width && layer.height() == height) {
+                copyGrid(layer, tiles);
+                return;
+            }
+            std::cerr << "Region " << regionX << "," << regionY << " is the wrong size or tile width" << std::endl;
+        }
+        tiles.resize(width, height);
+    }
+};
+
+#endif // REGION_PAGER_H
@@ -0,0 +1,220 @@
+#ifndef TILE_GRID_H
+#define TILE_GRID_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// A tile map in one contiguous buffer.
+//
+// Tile (x, y) lives at data()[y * stride() + x]. Every row has the same
+// width; a map file with ragged lines is padded with 0. at() is unchecked
+// for inner loops that already know they are in bounds; get() and set()
+// check and treat anything outside as the fill value. rows() walks the map
+// a row at a time, each row a plain pointer range.
+//
+// TileGrid holds one byte per tile, TileGrid16 two for maps with more than
+// 256 tile kinds. Header only.
+
+// One row of a grid
+template <typename T>
+class TileRow {
+public:
+    TileRow(T* first, int count) : mFirst(first), mCount(count) {}
+
+    T* begin() const { return mFirst; }
+    T* end() const { return mFirst + mCount; }
+    int size() const { return mCount; }
+    T& operator[](int x) const { return mFirst[x]; }
+
+private:
+    T* mFirst;
+    int mCount;
+};
+
+// Steps through a grid's rows, top to bottom
+template <typename T>
+class TileRowIterator {
+public:
+    TileRowIterator(T* row, int width, std::ptrdiff_t stride) : mRow(row), mWidth(width), mStride(stride) {}
+
+    TileRow<T> operator*() const { return TileRow<T>(mRow, mWidth); }
+    TileRowIterator& operator++() {
+        mRow += mStride;
+        return *this;
+    }
+    bool operator!=(const TileRowIterator& other) const { return mRow != other.mRow; }
+
+private:
+    T* mRow;
+    int mWidth;
+    std::ptrdiff_t mStride;
+};
+
+template <typename T>
+class TileRowRange {
+public:
+    TileRowRange(T* first, int width, int height, std::ptrdiff_t stride)
+        : mFirst(first), mWidth(width), mHeight(height), mStride(stride) {}
+
+    TileRowIterator<T> begin() const { return TileRowIterator<T>(mFirst, mWidth, mStride); }
+    TileRowIterator<T> end() const { return TileRowIterator<T>(mFirst + mHeight * mStride, mWidth, mStride); }
+
+private:
+    T* mFirst;
+    int mWidth;
+    int mHeight;
+    std::ptrdiff_t mStride;
+};
+
+template <typename T>
+class TileGridT {
+public:
+    typedef T Tile;
+
+    TileGridT() : mWidth(0), mHeight(0), mFill(0) {}
+    TileGridT(int width, int height, T fill = 0) : mWidth(0), mHeight(0), mFill(0) {
+        resize(width, height, fill);
+    }
+
+    // Drops the old contents; every tile becomes fill
+    void resize(int width, int height, T fill = 0) {
+        mWidth = width > 0 ? width : 0;
+        mHeight = height > 0 ? height : 0;
+        mFill = fill;
+        mTiles.assign(static_cast<std::size_t>(mWidth) * mHeight, fill);
+    }
+
+    int width() const { return mWidth; }
+    int height() const { return mHeight; }
+    // Tiles from one row to the next
+    std::ptrdiff_t stride() const { return mWidth; }
+    bool empty() const { return mTiles.empty(); }
+    T* data() { return mTiles.data(); }
+    const T* data() const { return mTiles.data(); }
+
+    bool inBounds(int x, int y) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(mWidth) && static_cast<unsigned>(y) < static_cast<unsigned>(mHeight);
+    }
+
+    // Unchecked
+    T& at(int x, int y) { return mTiles[y * stride() + x]; }
+    const T& at(int x, int y) const { return mTiles[y * stride() + x]; }
+
+    // Checked; outside the grid reads as the fill value
+    T get(int x, int y) const { return inBounds(x, y) ? at(x, y) : mFill; }
+    // Checked; returns false and changes nothing outside the grid
+    bool set(int x, int y, T tile) {
+        if (!inBounds(x, y)) return false;
+        at(x, y) = tile;
+        return true;
+    }
+
+    TileRow<T> row(int y) { return TileRow<T>(data() + y * stride(), mWidth); }
+    TileRow<const T> row(int y) const { return TileRow<const T>(data() + y * stride(), mWidth); }
+    TileRowRange<T> rows() { return TileRowRange<T>(data(), mWidth, mHeight, stride()); }
+    TileRowRange<const T> rows() const { return TileRowRange<const T>(data(), mWidth, mHeight, stride()); }
+
+private:
+    int mWidth;
+    int mHeight;
+    T mFill;
+    std::vector<T> mTiles;
+};
+
+typedef TileGridT<std::uint8_t> TileGrid;
+typedef TileGridT<std::uint16_t> TileGrid16;
+
+// Read-only grid over tiles someone else owns, e.g. a memory-mapped level
+// file. Same accessors as TileGridT.
+template <typename T>
+class TileGridViewT {
+public:
+    typedef T Tile;
+
+    TileGridViewT() : mTiles(nullptr), mWidth(0), mHeight(0), mStride(0) {}
+    TileGridViewT(const T* tiles, int width, int height, std::ptrdiff_t stride)
+        : mTiles(tiles), mWidth(width), mHeight(height), mStride(stride) {}
+    TileGridViewT(const TileGridT<T>& grid)
+        : mTiles(grid.data()), mWidth(grid.width()), mHeight(grid.height()), mStride(grid.stride()) {}
+
+    int width() const { return mWidth; }
+    int height() const { return mHeight; }
+    std::ptrdiff_t stride() const { return mStride; }
+    bool empty() const { return mWidth == 0 || mHeight == 0; }
+    const T* data() const { return mTiles; }
+
+    bool inBounds(int x, int y) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(mWidth) && static_cast<unsigned>(y) < static_cast<unsigned>(mHeight);
+    }
+    const T& at(int x, int y) const { return mTiles[y * mStride + x]; }
+    T get(int x, int y) const { return inBounds(x, y) ? at(x, y) : T(0); }
+
+    TileRow<const T> row(int y) const { return TileRow<const T>(mTiles + y * mStride, mWidth); }
+    TileRowRange<const T> rows() const { return TileRowRange<const T>(mTiles, mWidth, mHeight, mStride); }
+
+private:
+    const T* mTiles;
+    int mWidth;
+    int mHeight;
+    std::ptrdiff_t mStride;
+};
+
+typedef TileGridViewT<std::uint8_t> TileGridView;
+typedef TileGridViewT<std::uint16_t> TileGridView16;
+
+// Copies a view into a grid of the same size
+template <typename T>
+void copyGrid(const TileGridViewT<T>& view, TileGridT<T>& grid) {
+    grid.resize(view.width(), view.height());
+    for (int y = 0; y < view.height(); ++y) {
+        TileRow<const T> source = view.row(y);
+        std::copy(source.begin(), source.end(), grid.row(y).begin());
+    }
+}
+
+// Reads a map with one row per line and one digit per tile. Characters
+// that are not digits are skipped; short rows are padded with 0. Returns
+// false if the file cannot be opened.
+template <typename T>
+bool loadDigitGrid(const std::string& path, TileGridT<T>& grid) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Error opening map file: " << path << std::endl;
+        return false;
+    }
+
+    // Digits of every row back to back, then copied in at the final width
+    std::vector<T> tiles;
+    std::vector<std::size_t> rowStarts;
+    std::size_t width = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        rowStarts.push_back(tiles.size());
+        for (char ch : line) {
+            if (ch >= '0' && ch <= '9') {
+                tiles.push_back(static_cast<T>(ch - '0'));
+            }
+        }
+        std::size_t length = tiles.size() - rowStarts.back();
+        width = length > width ? length : width;
+    }
+    rowStarts.push_back(tiles.size());
+
+    int height = static_cast<int>(rowStarts.size()) - 1;
+    grid.resize(static_cast<int>(width), height);
+    for (int y = 0; y < height; ++y) {
+        std::size_t start = rowStarts[y];
+        std::size_t length = rowStarts[y + 1] - start;
+        for (std::size_t x = 0; x < length; ++x) {
+            grid.at(static_cast<int>(x), y) = tiles[start + x];
+        }
+    }
+    return true;
+}
+
+#endif // TILE_GRID_H
@@ -0,0 +1,97 @@
+// Converts text maps to the binary level format in common/level_file.h.
+//
+//   level_convert [--wide] OUT.lvl IN [IN...]
+//   level_convert --regions SIZE OUTDIR IN
+//
+// Each input becomes one layer, in order. An input is read as CSV (comma
+// separated tile numbers, one row per line) if it contains a comma, and
+// otherwise as the one-digit-per-tile map.txt format. Short rows are
+// padded with 0; every input must have the same size. Tiles are one byte
+// unless --wide is given, which allows values up to 65535.
+//
+// --regions splits one map into a streamed level instead: a directory of
+// SIZE x SIZE tile level files (see common/region_pager.h). SIZE should
+// be a multiple of 16 for platform_scroller.
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../csv_map.h"
+#include "../level_file.h"
+#include "../region_pager.h"
+
+template <typename T>
+static bool loadGrid(const std::string& path, TileGridT<T>& grid) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error opening map file: " << path << std::endl;
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+    if (text.find(',') != std::string::npos) {
+        std::vector<CsvMapError> errors;
+        bool ok = parseCsvGrid(text.data(), text.size(), grid, errors);
+        for (const CsvMapError& error : errors) {
+            std::cerr << path << ":" << error.row << ":" << error.column << ": bad tile '" << error.cell << "'" << std::endl;
+        }
+        return ok;
+    }
+    return loadDigitGrid(path, grid);
+}
+
+template <typename T>
+static int convert(const char* output, char** inputs, int inputCount) {
+    std::vector<TileGridT<T>> grids(inputCount);
+    std::vector<const TileGridT<T>*> layers;
+    for (int i = 0; i < inputCount; ++i) {
+        if (!loadGrid(inputs[i], grids[i])) {
+            return 1;
+        }
+        layers.push_back(&grids[i]);
+    }
+    if (!writeLevel(output, layers)) {
+        return 1;
+    }
+    std::cout << output << ": " << grids[0].width() << " x " << grids[0].height() << " tiles, "
+              << inputCount << (inputCount == 1 ? " layer, " : " layers, ") << sizeof(T) << " byte tiles" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--regions") == 0) {
+        int regionSize = argc > 2 ? std::atoi(argv[2]) : 0;
+        TileGrid grid;
+        if (argc != 5) {
+            std::cerr << "Usage: " << argv[0] << " --regions SIZE OUTDIR IN" << std::endl;
+            return 1;
+        }
+        if (!checkRegionSize(regionSize)) {
+            return 1;
+        }
+        if (!loadGrid(argv[4], grid) || !writeRegions(argv[3], grid, regionSize)) {
+            return 1;
+        }
+        std::cout << argv[3] << ": " << grid.width() << " x " << grid.height() << " tiles in regions of " << regionSize << std::endl;
+        return 0;
+    }
+
+    int first = 1;
+    bool wide = false;
+    if (argc > first && std::strcmp(argv[first], "--wide") == 0) {
+        wide = true;
+        ++first;
+    }
+    if (argc - first < 2) {
+        std::cerr << "Usage: " << argv[0] << " [--wide] OUT.lvl IN [IN...]" << std::endl;
+        std::cerr << "       " << argv[0] << " --regions SIZE OUTDIR IN" << std::endl;
+        return 1;
+    }
+    if (wide) {
+        return convert<std::uint16_t>(argv[first], argv + first + 1, argc - first - 1);
+    }
+    return convert<std::uint8_t>(argv[first], argv + first + 1, argc - first - 1);
+}
@@ -2,6 +2,18 @@
 #include <SDL2/SDL_ttf.h>
 #include <iostream>
 #include <string>
+#include "../common/dirty_present.h"
+
+const int SCREEN_WIDTH = 1920;
+const int SCREEN_HEIGHT = 1080;
+
+// HUD layout
+const int HUD_X = 50;
+const int TEXT_LINE_HEIGHT = 50; // each text line owns this band, from its y down
+const int SHIELD_Y = 200;
+const int SHIELD_BOX_SIZE = 30;
+const int SHIELD_SPACING = 10;
+const int SHIELD_MAX = 7;
 
 // Define the initial values
 int health = 100;
@@ -32,13 +44,18 @@ void renderShieldBoxes(SDL_Renderer* renderer, int shieldStrength, SDL_Color box
 
     // Draw empty boxes for the remaining slots
     SDL_Color emptyBoxColor = {100, 100, 100, 255}; // Grey for empty boxes
-    for (int i = shieldStrength; i < 7; ++i) {
+    for (int i = shieldStrength; i < SHIELD_MAX; ++i) {
         SDL_Rect box = {x + i * (boxWidth + spacing), y, boxWidth, boxHeight};
         SDL_SetRenderDrawColor(renderer, emptyBoxColor.r, emptyBoxColor.g, emptyBoxColor.b, emptyBoxColor.a);
         SDL_RenderDrawRect(renderer, &box); // Draw an empty box
     }
 }
 
+// Whether area reaches any of the rows from y to y + height
+bool overlapsRows(const SDL_Rect& area, int y, int height) {
+    return area.y < y + height && y < area.y + area.h;
+}
+
 int main(int argc, char* argv[]) {
     // Initialize SDL and SDL_ttf
     if (SDL_Init(SDL_INIT_VIDEO) < 0 || TTF_Init() < 0) {
@@ -47,7 +64,7 @@ int main(int argc, char* argv[]) {
     }
 
     // Create a window and renderer
-    SDL_Window* window = SDL_CreateWindow("HUD Example", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1920, 1080, SDL_WINDOW_SHOWN);
+    SDL_Window* window = SDL_CreateWindow("HUD Example", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
     SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
 
     // Load font
@@ -63,19 +80,45 @@ int main(int argc, char* argv[]) {
     SDL_Color grenadesColor = {255, 255, 0, 255};   // Yellow
     SDL_Color shieldBoxColor = {0, 0, 255, 255};    // Blue
 
+    // Draws the part of the HUD inside area. Text is only rendered for the
+    // lines the area reaches.
+    auto renderHud = [&](const SDL_Rect& area) {
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); // Black background
+        SDL_RenderFillRect(renderer, &area);
+        if (overlapsRows(area, 50, TEXT_LINE_HEIGHT)) {
+            renderText(renderer, font, "Health: " + std::to_string(health), healthColor, HUD_X, 50);
+        }
+        if (overlapsRows(area, 100, TEXT_LINE_HEIGHT)) {
+            renderText(renderer, font, "Ammo: " + std::to_string(ammo), ammoColor, HUD_X, 100);
+        }
+        if (overlapsRows(area, 150, TEXT_LINE_HEIGHT)) {
+            renderText(renderer, font, "Grenades: " + std::to_string(grenades), grenadesColor, HUD_X, 150);
+        }
+        if (overlapsRows(area, SHIELD_Y, SHIELD_BOX_SIZE)) {
+            renderShieldBoxes(renderer, shieldStrength, shieldBoxColor, HUD_X, SHIELD_Y, SHIELD_BOX_SIZE, SHIELD_BOX_SIZE, SHIELD_SPACING);
+        }
+    };
+
+    // The HUD is kept in a texture; only the parts that change are redrawn,
+    // and a frame where nothing changed is not presented at all
+    DirtyPresenter presenter(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+    DirtyRects& dirty = presenter.dirty();
+
     // Game loop
     bool running = true;
     SDL_Event event;
 
     while (running) {
         // Event handling
+        int previousShield = shieldStrength;
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = false;
             }
+            presenter.handleEvent(event);
             // Simulate shield power-up on pressing the 'P' key
             if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_p) {
-                if (shieldStrength < 7) {
+                if (shieldStrength < SHIELD_MAX) {
                     shieldStrength++; // Increase shield strength
                 }
             }
@@ -87,25 +130,17 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        // Clear the screen
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); // Black background
-        SDL_RenderClear(renderer);
-
-        // Render HUD elements
-        renderText(renderer, font, "Health: " + std::to_string(health), healthColor, 50, 50);
-        renderText(renderer, font, "Ammo: " + std::to_string(ammo), ammoColor, 50, 100);
-        renderText(renderer, font, "Grenades: " + std::to_string(grenades), grenadesColor, 50, 150);
-
-        // Render shield boxes
-        renderShieldBoxes(renderer, shieldStrength, shieldBoxColor, 50, 200, 30, 30, 10);
+        if (shieldStrength != previousShield) {
+            dirty.add(HUD_X, SHIELD_Y, SHIELD_MAX * (SHIELD_BOX_SIZE + SHIELD_SPACING) - SHIELD_SPACING, SHIELD_BOX_SIZE);
+        }
 
-        // Present the renderer
-        SDL_RenderPresent(renderer);
+        presenter.present(renderHud);
 
         SDL_Delay(16); // Simulate ~60 FPS
     }
 
     // Cleanup
+    presenter.close();
     TTF_CloseFont(font);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -0,0 +1,11 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+// Number of calls to global operator new/new[] since program start.
+// Counted by the replacement operators in alloc_counter.cpp; used by the
+// headless benchmark to check that the steady-state loop does not allocate.
+std::size_t allocationCount();
+
+#endif // ALLOC_COUNTER_H
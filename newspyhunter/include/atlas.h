@@ -0,0 +1,69 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <SDL2/SDL.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Skyline bottom-left rectangle packer. Keeps the top edge of the packed
+// area as a list of horizontal segments and places each rectangle where it
+// ends up lowest, then leftmost.
+class SkylinePacker {
+public:
+    SkylinePacker(int width, int height);
+
+    // Finds room for a w x h rectangle. Returns false if it does not fit.
+    bool insert(int w, int h, SDL_Rect& out);
+
+private:
+    struct Segment {
+        int x, y, w;
+    };
+
+    bool fits(std::size_t i, int w, int h, int& y) const;
+
+    int mWidth;
+    int mHeight;
+    std::vector<Segment> mSkyline;
+};
+
+// Many images packed into one texture, with a name -> sub-rect table.
+//
+// Built either at runtime from a list of image files (build) or loaded from
+// a prebuilt image + metadata pair written by save, e.g. by
+// `game --pack-atlas DIR OUT`. The metadata is plain text:
+//   atlas <image file> <width> <height>
+//   <name> <x> <y> <w> <h>
+// where name is the source file name without its extension.
+class TextureAtlas {
+public:
+    TextureAtlas();
+    ~TextureAtlas();
+
+    // Packs the given images. Cyan (0, 255, 255) is keyed out like
+    // LTexture::loadFromFile does. The result is kept as a surface until
+    // createTexture or save is called.
+    bool build(const std::vector<std::string>& paths);
+    bool buildFromDirectory(const std::string& dir);
+
+    bool save(const std::string& imagePath, const std::string& metaPath) const;
+    bool load(SDL_Renderer* renderer, const std::string& metaPath);
+    bool createTexture(SDL_Renderer* renderer);
+
+    void free();
+
+    const SDL_Rect* find(const std::string& name) const;
+    SDL_Texture* getTexture() const;
+    int getWidth() const;
+    int getHeight() const;
+
+private:
+    SDL_Surface* mSurface;
+    SDL_Texture* mTexture;
+    int mWidth;
+    int mHeight;
+    std::map<std::string, SDL_Rect> mRegions;
+};
+
+#endif // ATLAS_H
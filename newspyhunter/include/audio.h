@@ -0,0 +1,97 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <atomic>
+#include <vector>
+
+// Decides which sound effects actually get a mixer channel.
+//
+// Channels are split into groups (Mix_GroupChannels). Each sound belongs to
+// a group and has a priority, a minimum interval between plays and a cap on
+// simultaneous voices. When its group is full a new sound steals the
+// lowest-priority, oldest voice, or is dropped if everything playing
+// matters more. Repeats inside the minimum interval are dropped, so a
+// hundred explosions on one tick cost a few voices, not a hundred.
+//
+// The engine is a continuous loop on its own channel whose pitch can be
+// changed at any time; it is resampled on the fly by a mixer effect.
+class VoiceManager {
+public:
+    struct Stats {
+        int requested;
+        int started;
+        int stolen;
+        int rateLimited;
+        int rejected;
+    };
+
+    VoiceManager();
+
+    // Allocates the mixer channels. Call after Mix_OpenAudio.
+    bool init(int channels);
+
+    // Reserves the next `channels` channels as a group; returns its tag
+    int addGroup(int channels);
+
+    // Registers a sound effect; returns its id for play()
+    int addSound(Mix_Chunk* chunk, int group, int priority, Uint32 minIntervalMs, int maxVoices);
+
+    // Plays a sound at time nowMs (game or wall time, but always the same
+    // clock). Returns the channel used, or -1 if the sound was dropped.
+    int play(int sound, Uint32 nowMs);
+
+    // Starts the engine loop on the first channel of group
+    bool startEngine(Mix_Chunk* engine, int group);
+    // 1.0 plays the engine sample as recorded
+    void setEnginePitch(float pitch);
+
+    // Halts every voice and the engine. Call before Mix_CloseAudio.
+    void stopAll();
+
+    const Stats& getStats() const;
+
+private:
+    struct Sound {
+        Mix_Chunk* chunk;
+        int group;
+        int priority;
+        Uint32 minIntervalMs;
+        int maxVoices;
+        Uint32 lastPlayMs;
+        bool hasPlayed;
+    };
+
+    struct Voice {
+        int sound;
+        int priority;
+        Uint32 startMs;
+    };
+
+    struct Group {
+        int firstChannel;
+        int channelCount;
+    };
+
+    static void engineEffect(int channel, void* stream, int len, void* udata);
+
+    std::vector<Sound> mSounds;
+    std::vector<Voice> mVoices; // indexed by channel
+    std::vector<Group> mGroups; // indexed by group tag
+    int mChannels;
+    int mNextChannel;
+    Stats mStats;
+
+    // Engine loop state. Only mEnginePitch is touched by both threads.
+    int mEngineChannel;
+    Mix_Chunk* mEngineSample;
+    Mix_Chunk* mEngineCarrier; // silent looping chunk the effect writes over
+    std::vector<Uint8> mSilence;
+    int mOutputChannels;
+    double mEnginePosition;
+    float mEngineCurrentPitch;
+    std::atomic<float> mEnginePitch;
+};
+
+#endif // AUDIO_H
@@ -0,0 +1,85 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <vector>
+
+// Uniform grid broadphase.
+//
+// Each frame: clear(), insert() every target box, build(), then query() with
+// each probe box. build() bucket-sorts the inserted boxes into cells (a
+// counting sort, no per-cell lists), so building is O(n) and a query only
+// looks at the cells its box touches. Boxes outside the grid are clamped
+// into the border cells, so nothing is ever missed. The buffers are reused,
+// so a steady frame does not allocate.
+class UniformGrid {
+public:
+    UniformGrid(int originX, int originY, int columns, int rows, int cellWidth, int cellHeight);
+
+    // Sizes the buffers up front so steady frames never reallocate
+    void reserve(std::size_t items, std::size_t cellsPerItem);
+
+    void clear();
+    void insert(Uint32 id, const SDL_Rect& box);
+    void build();
+
+    // Calls visit(id, box) once for every inserted box sharing a cell with
+    // box. The candidate still needs an exact overlap test. visit returns
+    // false to stop the query early.
+    template <typename Visit>
+    void query(const SDL_Rect& box, Visit visit);
+
+    std::size_t size() const;
+
+private:
+    struct Item {
+        Uint32 id;
+        SDL_Rect box;
+    };
+
+    void cellRange(const SDL_Rect& box, int& c0, int& r0, int& c1, int& r1) const;
+
+    int mOriginX;
+    int mOriginY;
+    int mColumns;
+    int mRows;
+    int mCellWidth;
+    int mCellHeight;
+    std::vector<Item> mItems;
+    std::vector<Uint32> mCellStart;   // mColumns * mRows + 1 prefix sums
+    std::vector<Uint32> mCellItems;   // item indices, grouped by cell
+    std::vector<Uint32> mStamp;       // last query that saw each item
+    Uint32 mQuery;
+};
+
+template <typename Visit>
+void UniformGrid::query(const SDL_Rect& box, Visit visit) {
+    if (mItems.empty()) {
+        return;
+    }
+    // Items spanning several cells must only be reported once per query
+    if (++mQuery == 0) {
+        std::fill(mStamp.begin(), mStamp.end(), 0);
+        mQuery = 1;
+    }
+    int c0, r0, c1, r1;
+    cellRange(box, c0, r0, c1, r1);
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            int cell = r * mColumns + c;
+            for (Uint32 k = mCellStart[cell]; k < mCellStart[cell + 1]; ++k) {
+                Uint32 item = mCellItems[k];
+                if (mStamp[item] == mQuery) {
+                    continue;
+                }
+                mStamp[item] = mQuery;
+                if (!visit(mItems[item].id, mItems[item].box)) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+#endif // BROADPHASE_H
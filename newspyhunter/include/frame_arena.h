@@ -0,0 +1,92 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Linear allocator for data that only lives for one frame.
+//
+// One block is allocated up front. allocate() bumps an offset, and reset()
+// at the end of the frame drops everything at once, so the frame does no
+// heap work at all. Nothing allocated here ever has its destructor run.
+// When the block is full allocate() returns null; the caller decides what
+// to do, and the miss is counted so the capacity can be tuned.
+class FrameArena {
+public:
+    explicit FrameArena(std::size_t capacity);
+
+    // Returns bytes aligned to align (a power of two), or null when full
+    void* allocate(std::size_t bytes, std::size_t align);
+
+    // Uninitialised room for count objects of type T, or null
+    template <typename T>
+    T* allocateArray(std::size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Frees everything allocated since the last reset
+    void reset();
+
+    std::size_t getUsed() const;
+    std::size_t getPeak() const;
+    std::size_t getCapacity() const;
+    std::size_t getFailedAllocations() const;
+
+private:
+    std::unique_ptr<unsigned char[]> mBuffer;
+    std::size_t mCapacity;
+    std::size_t mUsed;
+    std::size_t mPeak;
+    std::size_t mFailed;
+};
+
+// Fixed-capacity list carved out of a FrameArena, for per-frame collision
+// pairs, render commands and the like. Only valid until the arena is reset.
+// push_back returns false instead of growing when the list is full.
+template <typename T>
+class FrameList {
+    static_assert(std::is_trivially_destructible<T>::value, "FrameList never runs destructors");
+
+public:
+    FrameList() : mData(nullptr), mSize(0), mCapacity(0) {}
+
+    FrameList(FrameArena& arena, std::size_t capacity)
+        : mData(arena.allocateArray<T>(capacity)), mSize(0), mCapacity(0) {
+        if (mData) {
+            mCapacity = capacity;
+        }
+    }
+
+    bool push_back(const T& value) {
+        if (mSize == mCapacity) {
+            return false;
+        }
+        new (mData + mSize) T(value);
+        ++mSize;
+        return true;
+    }
+
+    void clear() { mSize = 0; }
+
+    T& operator[](std::size_t i) { return mData[i]; }
+    const T& operator[](std::size_t i) const { return mData[i]; }
+
+    std::size_t size() const { return mSize; }
+    std::size_t capacity() const { return mCapacity; }
+    bool empty() const { return mSize == 0; }
+    bool full() const { return mSize == mCapacity; }
+
+    T* begin() { return mData; }
+    T* end() { return mData + mSize; }
+    const T* begin() const { return mData; }
+    const T* end() const { return mData + mSize; }
+
+private:
+    T* mData;
+    std::size_t mSize;
+    std::size_t mCapacity;
+};
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,142 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Fixed-capacity object pool with generational handles.
+//
+// Objects live in slots that are allocated once up front. A free list hands
+// out slots on spawn, and a dense array of live slot indices is what gets
+// iterated, so spawn and kill are O(1) and iteration is O(live) no matter how
+// many objects have been spawned over the lifetime of the pool. Killing swaps
+// the last live entry into the hole, so iteration order is not stable.
+template <typename T>
+class Pool {
+public:
+    static constexpr std::uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    // Refers to one spawned object. Stale once the object is killed, because
+    // the slot's generation is bumped when it is reused.
+    struct Handle {
+        std::uint32_t index = INVALID_INDEX;
+        std::uint32_t generation = 0;
+
+        bool isValid() const { return index != INVALID_INDEX; }
+    };
+
+    explicit Pool(std::size_t capacity)
+        : mSlots(capacity), mGenerations(capacity, 0), mDenseIndex(capacity, INVALID_INDEX) {
+        mFreeList.reserve(capacity);
+        mDense.reserve(capacity);
+        // Hand out low slots first
+        for (std::size_t i = capacity; i > 0; --i) {
+            mFreeList.push_back(static_cast<std::uint32_t>(i - 1));
+        }
+    }
+
+    // Constructs a new object in a free slot. Returns an invalid handle when
+    // the pool is full; callers are expected to simply drop the spawn.
+    template <typename... Args>
+    Handle spawn(Args&&... args) {
+        if (mFreeList.empty()) {
+            return Handle();
+        }
+        std::uint32_t slot = mFreeList.back();
+        mFreeList.pop_back();
+        mSlots[slot].emplace(std::forward<Args>(args)...);
+        mDenseIndex[slot] = static_cast<std::uint32_t>(mDense.size());
+        mDense.push_back(slot);
+        return Handle{ slot, mGenerations[slot] };
+    }
+
+    bool isAlive(Handle h) const {
+        return h.index < mSlots.size() && mGenerations[h.index] == h.generation && mSlots[h.index].has_value();
+    }
+
+    T* get(Handle h) {
+        return isAlive(h) ? &*mSlots[h.index] : nullptr;
+    }
+
+    void kill(Handle h) {
+        if (isAlive(h)) {
+            killAt(mDenseIndex[h.index]);
+        }
+    }
+
+    // Kills the i-th live object. The last live object takes its place, so
+    // loops that kill while walking should walk backwards (see removeIf).
+    void killAt(std::size_t i) {
+        std::uint32_t slot = mDense[i];
+        std::uint32_t last = mDense.back();
+        mDense[i] = last;
+        mDenseIndex[last] = static_cast<std::uint32_t>(i);
+        mDense.pop_back();
+
+        mSlots[slot].reset();
+        mDenseIndex[slot] = INVALID_INDEX;
+        ++mGenerations[slot];
+        mFreeList.push_back(slot);
+    }
+
+    // Kills every live object for which pred returns true.
+    template <typename Pred>
+    void removeIf(Pred pred) {
+        for (std::size_t i = mDense.size(); i > 0; --i) {
+            if (pred(*mSlots[mDense[i - 1]])) {
+                killAt(i - 1);
+            }
+        }
+    }
+
+    void clear() {
+        while (!mDense.empty()) {
+            killAt(mDense.size() - 1);
+        }
+    }
+
+    // Dense (live-only) access
+    T& operator[](std::size_t i) { return *mSlots[mDense[i]]; }
+    const T& operator[](std::size_t i) const { return *mSlots[mDense[i]]; }
+    Handle handleAt(std::size_t i) const { return Handle{ mDense[i], mGenerations[mDense[i]] }; }
+
+    std::size_t size() const { return mDense.size(); }
+    std::size_t capacity() const { return mSlots.size(); }
+    bool empty() const { return mDense.empty(); }
+    bool full() const { return mFreeList.empty(); }
+
+    template <typename PoolT, typename ValueT>
+    class Iterator {
+    public:
+        Iterator(PoolT* pool, std::size_t i) : mPool(pool), mI(i) {}
+        ValueT& operator*() const { return (*mPool)[mI]; }
+        ValueT* operator->() const { return &(*mPool)[mI]; }
+        Iterator& operator++() { ++mI; return *this; }
+        bool operator!=(const Iterator& other) const { return mI != other.mI; }
+        bool operator==(const Iterator& other) const { return mI == other.mI; }
+
+    private:
+        PoolT* mPool;
+        std::size_t mI;
+    };
+
+    typedef Iterator<Pool, T> iterator;
+    typedef Iterator<const Pool, const T> const_iterator;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, mDense.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, mDense.size()); }
+
+private:
+    std::vector<std::optional<T>> mSlots;
+    std::vector<std::uint32_t> mGenerations;
+    std::vector<std::uint32_t> mFreeList;
+    std::vector<std::uint32_t> mDense;       // slot index of each live object
+    std::vector<std::uint32_t> mDenseIndex;  // position of each slot in mDense
+};
+
+#endif // POOL_H
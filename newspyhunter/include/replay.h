@@ -0,0 +1,82 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// A recorded session: the seed plus the input bits of every update step,
+// and optionally a hash of the game state every hashInterval steps.
+//
+// Inputs are run-length encoded, since a held key gives the same bits for
+// many steps in a row. File layout, all little endian:
+//   "SPYR"  u32 version  u64 seed  u32 hashInterval  u32 steps
+//   u32 runs, then per run: u8 input, LEB128 length
+//   u32 hashes, then per hash: u64
+class Replay {
+public:
+    static const Uint32 VERSION = 1;
+
+    Replay();
+
+    // Clears everything and starts a new recording
+    void start(Uint64 seed, Uint32 hashInterval);
+    void recordInput(Uint8 input);
+    void recordHash(Uint64 hash);
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // Playback: rewind() then nextInput() once per step until it returns false
+    void rewind();
+    bool nextInput(Uint8& input);
+
+    Uint64 getSeed() const;
+    Uint32 getHashInterval() const;
+    Uint32 getStepCount() const;
+    std::size_t getRunCount() const;
+    std::size_t getHashCount() const;
+    Uint64 getHash(std::size_t i) const;
+
+private:
+    struct Run {
+        Uint8 input;
+        Uint32 length;
+    };
+
+    Uint64 mSeed;
+    Uint32 mHashInterval;
+    Uint32 mSteps;
+    std::vector<Run> mRuns;
+    std::vector<Uint64> mHashes;
+
+    // Playback position
+    std::size_t mRun;
+    Uint32 mRunStep;
+};
+
+// FNV-1a, for hashing game state into a replay
+class StateHash {
+public:
+    StateHash() : mHash(0xCBF29CE484222325ull) {}
+
+    void add(const void* data, std::size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            mHash = (mHash ^ bytes[i]) * 0x100000001B3ull;
+        }
+    }
+
+    template <typename T>
+    void add(const T& value) {
+        add(&value, sizeof(T));
+    }
+
+    Uint64 get() const { return mHash; }
+
+private:
+    Uint64 mHash;
+};
+
+#endif // REPLAY_H
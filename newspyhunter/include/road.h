@@ -0,0 +1,69 @@
+#ifndef ROAD_H
+#define ROAD_H
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Endless vertically scrolling road made of horizontal strips.
+//
+// Strip k covers road distance [k * stripHeight, (k + 1) * stripHeight).
+// A worker thread generates strips ahead of the camera into a fixed ring of
+// pixel buffers; the main thread uploads each finished buffer into the
+// ring's matching texture and draws the strips on screen. Memory is the
+// ring and nothing else, however far the car drives. Strips are a pure
+// function of (seed, k), so the road is the same every time for a seed.
+class RoadStreamer {
+public:
+    RoadStreamer();
+    ~RoadStreamer();
+
+    // ringSize must cover the screen plus the look-ahead
+    bool init(SDL_Renderer* renderer, int width, int screenHeight, int stripHeight, int ringSize, Uint64 seed);
+    void shutdown();
+
+    // Draws the road with `distance` pixels travelled; the bottom of the
+    // screen is at that distance
+    void render(double distance);
+
+    // Times a visible strip was not ready and was drawn as plain asphalt
+    int getMisses() const;
+
+private:
+    enum SlotState {
+        SLOT_EMPTY,      // free for the worker
+        SLOT_GENERATING, // worker is writing pixels
+        SLOT_READY,      // pixels done, texture not updated yet
+        SLOT_UPLOADED    // texture holds the strip
+    };
+
+    struct Slot {
+        long long index;
+        SlotState state;
+        std::vector<Uint32> pixels;
+        SDL_Texture* texture;
+    };
+
+    void workerLoop();
+    void generateStrip(long long index, Uint32* pixels) const;
+
+    SDL_Renderer* mRenderer;
+    int mWidth;
+    int mScreenHeight;
+    int mStripHeight;
+    Uint64 mSeed;
+    std::vector<Slot> mSlots;
+    int mMisses;
+
+    // Shared with the worker
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    long long mFirstNeeded;
+    bool mQuit;
+    std::thread mWorker;
+};
+
+#endif // ROAD_H
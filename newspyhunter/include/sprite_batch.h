@@ -0,0 +1,66 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <vector>
+#include "frame_arena.h"
+
+// Collects textured quads for a frame and submits them with one
+// SDL_RenderGeometry call per texture run instead of one SDL_RenderCopy per
+// sprite. Sprites are sorted by (layer, texture, submission order), so
+// layers keep painter's order and sprites within a layer are grouped by
+// texture. The queued sprites are a render command list in a frame arena,
+// and the vertex buffers are kept between frames, so a frame allocates
+// nothing. Needs SDL 2.0.18 or newer.
+class SpriteBatch {
+public:
+    SpriteBatch();
+
+    void setRenderer(SDL_Renderer* renderer);
+
+    // Arena the queued sprites live in, and how many one flush can hold.
+    // A full queue is flushed early; with no room at all in the arena each
+    // sprite is drawn on its own. The arena must not be reset between add()
+    // and flush().
+    void setArena(FrameArena* arena, std::size_t maxSprites);
+
+    // Sprites added after this draw above sprites on lower layers
+    void setLayer(int layer);
+
+    // src may be null for the whole texture; texW/texH are the texture size
+    void add(SDL_Texture* texture, int texW, int texH, const SDL_Rect* src, const SDL_Rect& dst);
+
+    // Sorts and draws everything added since the last flush
+    void flush();
+
+    int getLastDrawCalls() const;
+    std::size_t getLastSpriteCount() const;
+
+private:
+    struct Sprite {
+        int layer;
+        SDL_Texture* texture;
+        Uint32 order;
+        SDL_FRect uv;
+        SDL_Rect dst;
+    };
+
+    // Sorts and draws the queue, keeping the list for more sprites
+    void drawQueued();
+
+    SDL_Renderer* mRenderer;
+    FrameArena* mArena;
+    std::size_t mMaxSprites;
+    int mLayer;
+    Uint32 mOrder;
+    FrameList<Sprite> mSprites;
+    std::vector<SDL_Vertex> mVertices;
+    std::vector<int> mIndices;
+    int mDrawCalls;           // since the last flush
+    std::size_t mSpriteCount; // since the last flush
+    int mLastDrawCalls;
+    std::size_t mLastSpriteCount;
+};
+
+#endif // SPRITE_BATCH_H
@@ -0,0 +1,310 @@
+#include "atlas.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Gap left around every image so linear filtering never samples a neighbour
+const int ATLAS_PADDING = 1;
+const int ATLAS_MAX_SIZE = 4096;
+
+// SkylinePacker methods
+SkylinePacker::SkylinePacker(int width, int height) : mWidth(width), mHeight(height) {
+    mSkyline.push_back({ 0, 0, width });
+}
+
+bool SkylinePacker::fits(std::size_t i, int w, int h, int& y) const {
+    int x = mSkyline[i].x;
+    if (x + w > mWidth) {
+        return false;
+    }
+    int widthLeft = w;
+    y = mSkyline[i].y;
+    while (widthLeft > 0) {
+        if (i >= mSkyline.size()) {
+            return false;
+        }
+        y = std::max(y, mSkyline[i].y);
+        if (y + h > mHeight) {
+            return false;
+        }
+        widthLeft -= mSkyline[i].w;
+        ++i;
+    }
+    return true;
+}
+
+bool SkylinePacker::insert(int w, int h, SDL_Rect& out) {
+    int bestIndex = -1;
+    int bestY = mHeight;
+    int bestX = mWidth;
+    for (std::size_t i = 0; i < mSkyline.size(); ++i) {
+        int y;
+        if (fits(i, w, h, y) && (y < bestY || (y == bestY && mSkyline[i].x < bestX))) {
+            bestIndex = static_cast<int>(i);
+            bestY = y;
+            bestX = mSkyline[i].x;
+        }
+    }
+    if (bestIndex < 0) {
+        return false;
+    }
+    out = { bestX, bestY, w, h };
+
+    // Raise the skyline under the new rectangle
+    mSkyline.insert(mSkyline.begin() + bestIndex, { bestX, bestY + h, w });
+    std::size_t i = bestIndex + 1;
+    while (i < mSkyline.size()) {
+        int covered = mSkyline[i - 1].x + mSkyline[i - 1].w - mSkyline[i].x;
+        if (covered <= 0) {
+            break;
+        }
+        mSkyline[i].x += covered;
+        mSkyline[i].w -= covered;
+        if (mSkyline[i].w > 0) {
+            break;
+        }
+        mSkyline.erase(mSkyline.begin() + i);
+    }
+
+    // Merge neighbours at the same height
+    for (std::size_t j = 0; j + 1 < mSkyline.size();) {
+        if (mSkyline[j].y == mSkyline[j + 1].y) {
+            mSkyline[j].w += mSkyline[j + 1].w;
+            mSkyline.erase(mSkyline.begin() + j + 1);
+        } else {
+            ++j;
+        }
+    }
+    return true;
+}
+
+// TextureAtlas methods
+TextureAtlas::TextureAtlas() : mSurface(nullptr), mTexture(nullptr), mWidth(0), mHeight(0) {}
+
+TextureAtlas::~TextureAtlas() {
+    free();
+}
+
+void TextureAtlas::free() {
+    if (mSurface) {
+        SDL_FreeSurface(mSurface);
+        mSurface = nullptr;
+    }
+    if (mTexture) {
+        SDL_DestroyTexture(mTexture);
+        mTexture = nullptr;
+    }
+    mWidth = 0;
+    mHeight = 0;
+    mRegions.clear();
+}
+
+bool TextureAtlas::build(const std::vector<std::string>& paths) {
+    free();
+
+    struct Image {
+        std::string name;
+        SDL_Surface* surface;
+        SDL_Rect rect;
+    };
+    std::vector<Image> images;
+    bool success = true;
+    long long area = 0;
+    for (const std::string& path : paths) {
+        SDL_Surface* surface = IMG_Load(path.c_str());
+        if (!surface) {
+            std::cerr << "Unable to load image " << path << "! SDL_image Error: " << IMG_GetError() << std::endl;
+            success = false;
+            continue;
+        }
+        SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, 0, 0xFF, 0xFF));
+        // Copy pixels (and alpha) as-is instead of blending onto the empty atlas
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        images.push_back({ std::filesystem::path(path).stem().string(), surface, { 0, 0, 0, 0 } });
+        area += static_cast<long long>(surface->w + ATLAS_PADDING * 2) * (surface->h + ATLAS_PADDING * 2);
+    }
+
+    if (success && !images.empty()) {
+        // Tallest first packs tightest with a skyline
+        std::vector<Image*> order;
+        for (Image& image : images) {
+            order.push_back(&image);
+        }
+        std::sort(order.begin(), order.end(), [](const Image* a, const Image* b) {
+            return a->surface->h > b->surface->h;
+        });
+
+        // Start at the smallest power of two that could hold the area and
+        // grow (width first) until everything fits
+        int width = 64;
+        int height = 64;
+        while (static_cast<long long>(width) * height < area) {
+            (width <= height ? width : height) *= 2;
+        }
+        bool packed = false;
+        while (!packed && width <= ATLAS_MAX_SIZE && height <= ATLAS_MAX_SIZE) {
+            SkylinePacker packer(width, height);
+            packed = true;
+            for (Image* image : order) {
+                SDL_Rect r;
+                if (!packer.insert(image->surface->w + ATLAS_PADDING * 2, image->surface->h + ATLAS_PADDING * 2, r)) {
+                    packed = false;
+                    break;
+                }
+                image->rect = { r.x + ATLAS_PADDING, r.y + ATLAS_PADDING, image->surface->w, image->surface->h };
+            }
+            if (!packed) {
+                (width <= height ? width : height) *= 2;
+            }
+        }
+
+        if (!packed) {
+            std::cerr << "Images do not fit in a " << ATLAS_MAX_SIZE << "x" << ATLAS_MAX_SIZE << " atlas!" << std::endl;
+            success = false;
+        } else {
+            // New surfaces start zeroed, i.e. fully transparent
+            mSurface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+            if (!mSurface) {
+                std::cerr << "Unable to create atlas surface! SDL Error: " << SDL_GetError() << std::endl;
+                success = false;
+            } else {
+                mWidth = width;
+                mHeight = height;
+                for (Image& image : images) {
+                    SDL_Rect dst = image.rect;
+                    SDL_BlitSurface(image.surface, nullptr, mSurface, &dst);
+                    mRegions[image.name] = image.rect;
+                }
+            }
+        }
+    }
+
+    for (Image& image : images) {
+        SDL_FreeSurface(image.surface);
+    }
+    if (!success) {
+        free();
+    }
+    return success;
+}
+
+bool TextureAtlas::buildFromDirectory(const std::string& dir) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (entry.is_regular_file() && (ext == ".bmp" || ext == ".png")) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    if (ec) {
+        std::cerr << "Unable to read directory " << dir << ": " << ec.message() << std::endl;
+        return false;
+    }
+    // Directory order is unspecified; sort so the output is reproducible
+    std::sort(paths.begin(), paths.end());
+    return build(paths);
+}
+
+bool TextureAtlas::save(const std::string& imagePath, const std::string& metaPath) const {
+    if (!mSurface) {
+        std::cerr << "Atlas has no pixels to save!" << std::endl;
+        return false;
+    }
+    if (IMG_SavePNG(mSurface, imagePath.c_str()) != 0) {
+        std::cerr << "Unable to save atlas image " << imagePath << "! SDL_image Error: " << IMG_GetError() << std::endl;
+        return false;
+    }
+    std::ofstream meta(metaPath);
+    if (!meta) {
+        std::cerr << "Unable to write atlas metadata " << metaPath << std::endl;
+        return false;
+    }
+    // The image is referenced relative to the metadata file
+    meta << "atlas " << std::filesystem::path(imagePath).filename().string() << " " << mWidth << " " << mHeight << "\n";
+    for (const auto& region : mRegions) {
+        const SDL_Rect& r = region.second;
+        meta << region.first << " " << r.x << " " << r.y << " " << r.w << " " << r.h << "\n";
+    }
+    return static_cast<bool>(meta);
+}
+
+bool TextureAtlas::load(SDL_Renderer* renderer, const std::string& metaPath) {
+    free();
+    std::ifstream meta(metaPath);
+    if (!meta) {
+        return false;
+    }
+
+    std::string line;
+    std::string tag;
+    std::string imageName;
+    if (!std::getline(meta, line) || !(std::istringstream(line) >> tag >> imageName >> mWidth >> mHeight) || tag != "atlas") {
+        std::cerr << "Bad atlas header in " << metaPath << std::endl;
+        free();
+        return false;
+    }
+    int lineNumber = 1;
+    while (std::getline(meta, line)) {
+        ++lineNumber;
+        if (line.empty()) {
+            continue;
+        }
+        std::string name;
+        SDL_Rect r;
+        if (!(std::istringstream(line) >> name >> r.x >> r.y >> r.w >> r.h)) {
+            std::cerr << "Bad atlas entry at " << metaPath << ":" << lineNumber << std::endl;
+            free();
+            return false;
+        }
+        mRegions[name] = r;
+    }
+
+    std::string imagePath = (std::filesystem::path(metaPath).parent_path() / imageName).string();
+    mSurface = IMG_Load(imagePath.c_str());
+    if (!mSurface) {
+        std::cerr << "Unable to load atlas image " << imagePath << "! SDL_image Error: " << IMG_GetError() << std::endl;
+        free();
+        return false;
+    }
+    return createTexture(renderer);
+}
+
+bool TextureAtlas::createTexture(SDL_Renderer* renderer) {
+    if (!mSurface) {
+        return false;
+    }
+    mTexture = SDL_CreateTextureFromSurface(renderer, mSurface);
+    if (!mTexture) {
+        std::cerr << "Unable to create atlas texture! SDL Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_SetTextureBlendMode(mTexture, SDL_BLENDMODE_BLEND);
+    mWidth = mSurface->w;
+    mHeight = mSurface->h;
+    // Pixels now live on the renderer side
+    SDL_FreeSurface(mSurface);
+    mSurface = nullptr;
+    return true;
+}
+
+const SDL_Rect* TextureAtlas::find(const std::string& name) const {
+    auto it = mRegions.find(name);
+    return it != mRegions.end() ? &it->second : nullptr;
+}
+
+SDL_Texture* TextureAtlas::getTexture() const {
+    return mTexture;
+}
+
+int TextureAtlas::getWidth() const {
+    return mWidth;
+}
+
+int TextureAtlas::getHeight() const {
+    return mHeight;
+}
@@ -0,0 +1,195 @@
+#include "audio.h"
+#include <iostream>
+
+// Length of the silent carrier chunk that keeps the engine channel busy
+const int ENGINE_CARRIER_BYTES = 4096;
+// Fraction of the way to the target pitch covered per mixed buffer
+const float ENGINE_PITCH_SMOOTHING = 0.2f;
+
+VoiceManager::VoiceManager()
+    : mChannels(0), mNextChannel(0), mStats({ 0, 0, 0, 0, 0 }), mEngineChannel(-1), mEngineSample(nullptr),
+      mEngineCarrier(nullptr), mOutputChannels(2), mEnginePosition(0.0), mEngineCurrentPitch(1.0f), mEnginePitch(1.0f) {}
+
+bool VoiceManager::init(int channels) {
+    if (Mix_AllocateChannels(channels) != channels) {
+        std::cerr << "Unable to allocate " << channels << " mixer channels! SDL_mixer Error: " << Mix_GetError() << std::endl;
+        return false;
+    }
+    mChannels = channels;
+    mNextChannel = 0;
+    mVoices.assign(channels, { -1, 0, 0 });
+    mGroups.clear();
+    mSounds.clear();
+    mStats = { 0, 0, 0, 0, 0 };
+    return true;
+}
+
+int VoiceManager::addGroup(int channels) {
+    if (mNextChannel + channels > mChannels) {
+        std::cerr << "Not enough mixer channels for a group of " << channels << std::endl;
+        return -1;
+    }
+    int tag = static_cast<int>(mGroups.size());
+    Mix_GroupChannels(mNextChannel, mNextChannel + channels - 1, tag);
+    mGroups.push_back({ mNextChannel, channels });
+    mNextChannel += channels;
+    return tag;
+}
+
+int VoiceManager::addSound(Mix_Chunk* chunk, int group, int priority, Uint32 minIntervalMs, int maxVoices) {
+    mSounds.push_back({ chunk, group, priority, minIntervalMs, maxVoices, 0, false });
+    return static_cast<int>(mSounds.size()) - 1;
+}
+
+int VoiceManager::play(int sound, Uint32 nowMs) {
+    ++mStats.requested;
+    if (sound < 0 || sound >= static_cast<int>(mSounds.size()) || !mSounds[sound].chunk) {
+        ++mStats.rejected;
+        return -1;
+    }
+    Sound& s = mSounds[sound];
+    if (s.hasPlayed && nowMs - s.lastPlayMs < s.minIntervalMs) {
+        ++mStats.rateLimited;
+        return -1;
+    }
+    const Group& group = mGroups[s.group];
+
+    // Find this sound's voices and the cheapest voice to steal
+    int sameCount = 0;
+    int oldestSame = -1;
+    int victim = -1;
+    for (int ch = group.firstChannel; ch < group.firstChannel + group.channelCount; ++ch) {
+        if (!Mix_Playing(ch)) {
+            continue;
+        }
+        const Voice& v = mVoices[ch];
+        if (v.sound == sound) {
+            ++sameCount;
+            if (oldestSame < 0 || v.startMs < mVoices[oldestSame].startMs) {
+                oldestSame = ch;
+            }
+        }
+        if (victim < 0 || v.priority < mVoices[victim].priority
+            || (v.priority == mVoices[victim].priority && v.startMs < mVoices[victim].startMs)) {
+            victim = ch;
+        }
+    }
+
+    int channel;
+    if (sameCount >= s.maxVoices) {
+        // Restart the oldest copy rather than stack another one
+        channel = oldestSame;
+        ++mStats.stolen;
+    } else {
+        channel = Mix_GroupAvailable(s.group);
+        if (channel < 0) {
+            if (victim < 0 || mVoices[victim].priority > s.priority) {
+                ++mStats.rejected;
+                return -1;
+            }
+            channel = victim;
+            ++mStats.stolen;
+        }
+    }
+
+    Mix_HaltChannel(channel);
+    if (Mix_PlayChannel(channel, s.chunk, 0) < 0) {
+        ++mStats.rejected;
+        return -1;
+    }
+    mVoices[channel] = { sound, s.priority, nowMs };
+    s.lastPlayMs = nowMs;
+    s.hasPlayed = true;
+    ++mStats.started;
+    return channel;
+}
+
+bool VoiceManager::startEngine(Mix_Chunk* engine, int group) {
+    if (!engine || group < 0 || group >= static_cast<int>(mGroups.size())) {
+        return false;
+    }
+    int frequency;
+    Uint16 format;
+    int channels;
+    if (!Mix_QuerySpec(&frequency, &format, &channels)) {
+        return false;
+    }
+    mEngineChannel = mGroups[group].firstChannel;
+    mEngineSample = engine;
+    mOutputChannels = channels;
+    mEnginePosition = 0.0;
+
+    if (format != AUDIO_S16SYS) {
+        // The resampler only handles 16-bit output; play the loop unpitched
+        return Mix_PlayChannel(mEngineChannel, engine, -1) >= 0;
+    }
+
+    mSilence.assign(ENGINE_CARRIER_BYTES, 0);
+    mEngineCarrier = Mix_QuickLoad_RAW(mSilence.data(), static_cast<Uint32>(mSilence.size()));
+    if (!mEngineCarrier || Mix_PlayChannel(mEngineChannel, mEngineCarrier, -1) < 0) {
+        return false;
+    }
+    Mix_RegisterEffect(mEngineChannel, engineEffect, nullptr, this);
+    return true;
+}
+
+void VoiceManager::setEnginePitch(float pitch) {
+    mEnginePitch.store(pitch, std::memory_order_relaxed);
+}
+
+// Runs on the audio thread. Replaces the silent carrier with the engine
+// sample read at a fractional rate: linear interpolation, looping.
+void VoiceManager::engineEffect(int, void* stream, int len, void* udata) {
+    VoiceManager* self = static_cast<VoiceManager*>(udata);
+    const Sint16* src = reinterpret_cast<const Sint16*>(self->mEngineSample->abuf);
+    const int channels = self->mOutputChannels;
+    const int srcFrames = static_cast<int>(self->mEngineSample->alen / (sizeof(Sint16) * channels));
+    Sint16* out = static_cast<Sint16*>(stream);
+    const int outFrames = len / static_cast<int>(sizeof(Sint16) * channels);
+    if (srcFrames < 2) {
+        return;
+    }
+
+    float target = self->mEnginePitch.load(std::memory_order_relaxed);
+    self->mEngineCurrentPitch += (target - self->mEngineCurrentPitch) * ENGINE_PITCH_SMOOTHING;
+    const double step = self->mEngineCurrentPitch;
+
+    double pos = self->mEnginePosition;
+    for (int i = 0; i < outFrames; ++i) {
+        int i0 = static_cast<int>(pos);
+        int i1 = i0 + 1 < srcFrames ? i0 + 1 : 0;
+        float frac = static_cast<float>(pos - i0);
+        for (int c = 0; c < channels; ++c) {
+            float a = src[i0 * channels + c];
+            float b = src[i1 * channels + c];
+            out[i * channels + c] = static_cast<Sint16>(a + (b - a) * frac);
+        }
+        pos += step;
+        while (pos >= srcFrames) {
+            pos -= srcFrames;
+        }
+    }
+    self->mEnginePosition = pos;
+}
+
+void VoiceManager::stopAll() {
+    if (mEngineChannel >= 0) {
+        Mix_HaltChannel(mEngineChannel);
+        if (mEngineCarrier) {
+            Mix_UnregisterEffect(mEngineChannel, engineEffect);
+        }
+        mEngineChannel = -1;
+    }
+    if (mEngineCarrier) {
+        Mix_FreeChunk(mEngineCarrier);
+        mEngineCarrier = nullptr;
+    }
+    for (int ch = 0; ch < mChannels; ++ch) {
+        Mix_HaltChannel(ch);
+        mVoices[ch] = { -1, 0, 0 };
+    }
+}
+
+const VoiceManager::Stats& VoiceManager::getStats() const {
+    return mStats;
+}
@@ -0,0 +1,71 @@
+#include "broadphase.h"
+#include <algorithm>
+
+UniformGrid::UniformGrid(int originX, int originY, int columns, int rows, int cellWidth, int cellHeight)
+    : mOriginX(originX), mOriginY(originY), mColumns(columns), mRows(rows),
+      mCellWidth(cellWidth), mCellHeight(cellHeight), mCellStart(columns * rows + 1, 0), mQuery(0) {}
+
+void UniformGrid::reserve(std::size_t items, std::size_t cellsPerItem) {
+    mItems.reserve(items);
+    mCellItems.reserve(items * cellsPerItem);
+    if (mStamp.size() < items) {
+        mStamp.resize(items, 0);
+    }
+}
+
+void UniformGrid::clear() {
+    mItems.clear();
+}
+
+void UniformGrid::insert(Uint32 id, const SDL_Rect& box) {
+    mItems.push_back({ id, box });
+}
+
+void UniformGrid::cellRange(const SDL_Rect& box, int& c0, int& r0, int& c1, int& r1) const {
+    c0 = std::clamp((box.x - mOriginX) / mCellWidth, 0, mColumns - 1);
+    r0 = std::clamp((box.y - mOriginY) / mCellHeight, 0, mRows - 1);
+    c1 = std::clamp((box.x + box.w - mOriginX) / mCellWidth, 0, mColumns - 1);
+    r1 = std::clamp((box.y + box.h - mOriginY) / mCellHeight, 0, mRows - 1);
+}
+
+void UniformGrid::build() {
+    // Count entries per cell
+    std::fill(mCellStart.begin(), mCellStart.end(), 0);
+    for (const Item& item : mItems) {
+        int c0, r0, c1, r1;
+        cellRange(item.box, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                ++mCellStart[r * mColumns + c + 1];
+            }
+        }
+    }
+    for (std::size_t i = 1; i < mCellStart.size(); ++i) {
+        mCellStart[i] += mCellStart[i - 1];
+    }
+
+    // Scatter item indices into their cells, using the starts as cursors
+    mCellItems.resize(mCellStart.back());
+    for (Uint32 i = 0; i < mItems.size(); ++i) {
+        int c0, r0, c1, r1;
+        cellRange(mItems[i].box, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                mCellItems[mCellStart[r * mColumns + c]++] = i;
+            }
+        }
+    }
+    // The cursors now point at the next cell's start; shift them back
+    for (std::size_t i = mCellStart.size() - 1; i > 0; --i) {
+        mCellStart[i] = mCellStart[i - 1];
+    }
+    mCellStart[0] = 0;
+
+    if (mStamp.size() < mItems.size()) {
+        mStamp.resize(mItems.size(), 0);
+    }
+}
+
+std::size_t UniformGrid::size() const {
+    return mItems.size();
+}
@@ -0,0 +1,39 @@
+#include "frame_arena.h"
+#include <cstdint>
+
+FrameArena::FrameArena(std::size_t capacity)
+    : mBuffer(new unsigned char[capacity]), mCapacity(capacity), mUsed(0), mPeak(0), mFailed(0) {}
+
+void* FrameArena::allocate(std::size_t bytes, std::size_t align) {
+    std::uintptr_t base = reinterpret_cast<std::uintptr_t>(mBuffer.get());
+    std::size_t start = ((base + mUsed + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1)) - base;
+    if (start > mCapacity || bytes > mCapacity - start) {
+        ++mFailed;
+        return nullptr;
+    }
+    mUsed = start + bytes;
+    if (mUsed > mPeak) {
+        mPeak = mUsed;
+    }
+    return mBuffer.get() + start;
+}
+
+void FrameArena::reset() {
+    mUsed = 0;
+}
+
+std::size_t FrameArena::getUsed() const {
+    return mUsed;
+}
+
+std::size_t FrameArena::getPeak() const {
+    return mPeak;
+}
+
+std::size_t FrameArena::getCapacity() const {
+    return mCapacity;
+}
+
+std::size_t FrameArena::getFailedAllocations() const {
+    return mFailed;
+}
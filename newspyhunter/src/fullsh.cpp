@@ -1,8 +1,23 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_mixer.h>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
 #include <vector>
+#include "alloc_counter.h"
+#include "atlas.h"
+#include "audio.h"
+#include "broadphase.h"
+#include "frame_arena.h"
+#include "pool.h"
+#include "replay.h"
+#include "road.h"
+#include "sprite_batch.h"
 
 // Screen dimensions
 const int SCREEN_WIDTH = 640;
@@ -11,31 +26,118 @@ const int SCREEN_HEIGHT = 480;
 // Player car settings
 const int CAR_WIDTH = 60;
 const int CAR_HEIGHT = 30;
-const int CAR_SPEED = 5;
+const float CAR_SPEED = 300.0f; // pixels per second
 
 // Enemy car settings
 const int ENEMY_CAR_WIDTH = 50;
 const int ENEMY_CAR_HEIGHT = 30;
-const int ENEMY_CAR_SPEED = 3;
+const float ENEMY_CAR_SPEED = 180.0f;
+const float ENEMY_SPAWN_RATE = 1.2f; // expected new cars per second
 
 // 18-wheeler settings
 const int TRUCK_WIDTH = 100;
 const int TRUCK_HEIGHT = 60;
-const int TRUCK_SPEED = 2;
+const float TRUCK_SPEED = 120.0f;
 
 // Bullet settings
-const int BULLET_SPEED = 10;
+const float BULLET_SPEED = 600.0f;
+
+// Road scroll speed, and the strips it is streamed in. The ring holds the
+// strips on screen plus a few generated ahead of the camera.
+const float ROAD_SPEED = 240.0f;
+const int ROAD_STRIP_HEIGHT = 64;
+const int ROAD_RING_SIZE = SCREEN_HEIGHT / ROAD_STRIP_HEIGHT + 6;
+
+// Pool capacities. Spawns beyond these are dropped rather than allocated.
+const int MAX_ENEMY_CARS = 32;
+const int MAX_BULLETS = 64;
+const int MAX_TRUCKS = 2;
+
+// Most sprites one frame can queue, and the render arena that holds them
+const int MAX_SPRITES_PER_FRAME = 2 + MAX_ENEMY_CARS + MAX_TRUCKS + MAX_BULLETS;
+const std::size_t RENDER_ARENA_SIZE = 16 * 1024;
+
+// Sprite batch layers, drawn bottom to top
+enum RenderLayer {
+    LAYER_BACKGROUND = 0,
+    LAYER_VEHICLES = 1,
+    LAYER_BULLETS = 2
+};
+
+// Points for each kind of hit
+const int SCORE_ENEMY_CAR = 100;
+const int SCORE_TRUCK_HIT = 10;
+
+// Broadphase cells: one column per lane, rows a little taller than a car.
+// The grid starts one truck above the screen so cars and trucks still
+// entering are indexed properly.
+const int GRID_COLUMNS = 3;
+const int GRID_ROW_HEIGHT = 60;
+const int GRID_ORIGIN_Y = -TRUCK_HEIGHT;
+const int GRID_ROWS = (SCREEN_HEIGHT - GRID_ORIGIN_Y) / GRID_ROW_HEIGHT + 1;
+
+// The simulation always advances in steps of SIM_STEP seconds, whatever
+// the display refresh rate. A stalled frame is clamped to MAX_FRAME_TIME,
+// and at most MAX_STEPS_PER_FRAME steps are run before rendering, so a slow
+// machine slows the game down instead of falling further and further behind.
+const float SIM_STEP = 1.0f / 120.0f;
+const float MAX_FRAME_TIME = 0.25f;
+const int MAX_STEPS_PER_FRAME = 8;
+
+// Recordings hash the game state every REPLAY_HASH_INTERVAL steps (1 s)
+const Uint32 REPLAY_HASH_INTERVAL = 120;
+
+// Player input for one update step
+enum InputBits : Uint8 {
+    INPUT_LEFT = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_FIRE = 1 << 2 // only set on the step the fire key went down
+};
+
+// Sounds requested by an update step; the caller decides whether to play them
+enum SoundBits : Uint32 {
+    SOUND_EXPLOSION = 1 << 0,
+    SOUND_SHOOT = 1 << 1
+};
+
+// Mixer channel layout: the engine loop gets a channel to itself, gunfire
+// and explosions each get a group they cannot take from one another.
+const int MIXER_CHANNELS = 16;
+const int ENGINE_CHANNELS = 1;
+const int WEAPON_CHANNELS = 4;
+const int EXPLOSION_CHANNELS = 8;
+
+// Higher priority sounds steal voices from lower ones
+const int PRIORITY_SHOOT = 1;
+const int PRIORITY_EXPLOSION = 2;
+
+// Engine pitch at rest and at full steering speed
+const float ENGINE_PITCH_IDLE = 1.0f;
+const float ENGINE_PITCH_FULL = 1.3f;
 
 // Function declarations
-bool init();
+bool init(Uint32 rendererFlags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 bool loadMedia();
+bool setupVoices();
 void close();
 bool checkCollision(SDL_Rect a, SDL_Rect b);
+int runHeadless(int frames, Uint64 seed, const std::string& recordPath);
+int runReplay(const std::string& path, bool verify);
+int runStress(int enemyCars, int frames, bool batched);
+int runPackAtlas(const std::string& dir, const std::string& outPrefix);
+int runCollisionBench(int bullets, int enemyCars, int passes);
+int runAudioBench(bool managed);
 
 // SDL objects
 SDL_Window* gWindow = nullptr;
 SDL_Renderer* gRenderer = nullptr;
 
+// When set, LTexture::render queues plain (unrotated, unflipped) draws here
+SpriteBatch* gSpriteBatch = nullptr;
+
+// Unbatched SDL_RenderCopyEx calls made by LTexture::render
+int gCopyCalls = 0;
+
 // Texture wrapper class
 class LTexture {
 public:
@@ -43,6 +145,8 @@ public:
     ~LTexture();
 
     bool loadFromFile(std::string path);
+    // Refers to a named sub-rect of a shared atlas; the atlas keeps ownership
+    bool loadFromAtlas(const TextureAtlas& atlas, const std::string& name);
     void free();
     void render(int x, int y, SDL_Rect* clip = nullptr, double angle = 0.0, SDL_Point* center = nullptr, SDL_RendererFlip flip = SDL_FLIP_NONE);
     int getWidth();
@@ -50,24 +154,57 @@ public:
 
 private:
     SDL_Texture* mTexture;
+    bool mOwnsTexture;
+    SDL_Rect mRegion; // area of mTexture this image occupies
+    int mTextureWidth;
+    int mTextureHeight;
     int mWidth;
     int mHeight;
 };
 
+// Small deterministic PRNG (xorshift64*), so a seed fully determines a run
+class Rng {
+public:
+    explicit Rng(Uint64 seed = 1);
+
+    Uint32 next();
+    int nextInt(int n);
+    float nextFloat();
+    Uint64 getState() const;
+
+private:
+    Uint64 mState;
+};
+
+// Turns keyboard events into the input bits fed to update()
+class InputState {
+public:
+    InputState();
+
+    void handleEvent(SDL_Event& e);
+    Uint8 poll();
+
+private:
+    Uint8 mHeld;
+    Uint8 mPressed;
+};
+
 // The player-controlled car
 class Car {
 public:
     Car();
 
-    void handleEvent(SDL_Event& e);
-    void move();
-    void render();
-    SDL_Rect getCollider();
+    void setInput(Uint8 input);
+    void move(float dt);
+    float getVelocityX() const;
+    void render(float alpha) const;
+    SDL_Rect getCollider() const;
     void setPosition(int x, int y);
 
 private:
-    int mPosX, mPosY;
-    int mVelX;
+    float mPosX, mPosY;
+    float mPrevX, mPrevY; // position before the last move, for interpolation
+    float mVelX;
     SDL_Rect mCollider;
 };
 
@@ -79,15 +216,16 @@ public:
 
     Bullet(int x, int y);
 
-    void move();
-    void render();
-    SDL_Rect getCollider();
+    void move(float dt);
+    void render(float alpha) const;
+    SDL_Rect getCollider() const;
     bool isActive() const;
     void setActive(bool active);
 
 private:
-    int mPosX, mPosY;
-    int mVelX, mVelY;
+    float mPosX, mPosY;
+    float mPrevX, mPrevY; // position before the last move, for interpolation
+    float mVelX, mVelY;
     SDL_Rect mCollider;
     bool active;
 };
@@ -97,15 +235,16 @@ class EnemyCar {
 public:
     EnemyCar(int lane);
 
-    void move();
-    void render();
-    SDL_Rect getCollider();
+    void move(float dt);
+    void render(float alpha) const;
+    SDL_Rect getCollider() const;
     bool isAlive() const;
     void setAlive(bool alive);
 
 private:
-    int mPosX, mPosY;
-    int mVelY;
+    float mPosX, mPosY;
+    float mPrevX, mPrevY; // position before the last move, for interpolation
+    float mVelY;
     SDL_Rect mCollider;
     bool alive;
 };
@@ -115,33 +254,89 @@ class Truck {
 public:
     Truck();
 
-    void move();
-    void render();
-    SDL_Rect getCollider();
+    void move(float dt);
+    void render(float alpha) const;
+    SDL_Rect getCollider() const;
     bool isOnScreen() const;
     void setOnScreen(bool onScreen);
 
 private:
-    int mPosX, mPosY;
-    int mVelY;
+    float mPosX, mPosY;
+    float mPrevX, mPrevY; // position before the last move, for interpolation
+    float mVelY;
     SDL_Rect mCollider;
     bool onScreen;
 };
 
-// Globally used textures
+// What hit what during an update step
+enum HitKind {
+    HIT_BULLET_ENEMY,
+    HIT_BULLET_TRUCK,
+    HIT_PLAYER_ENEMY
+};
+
+// One collision found by the broadphase. Handles that do not apply to the
+// kind are left invalid. They may be stale once update() returns, so
+// consumers after that should only rely on kind and position.
+struct HitEvent {
+    HitKind kind;
+    Pool<Bullet>::Handle bullet;
+    Pool<EnemyCar>::Handle enemyCar;
+    Pool<Truck>::Handle truck;
+    SDL_Point position;
+};
+
+// Everything the simulation touches. update() only reads and writes this,
+// so the same state can be stepped with or without a window.
+struct GameState {
+    explicit GameState(Uint64 seed, int maxEnemyCars = MAX_ENEMY_CARS);
+
+    void restart();
+
+    Car playerCar;
+    Pool<Bullet> bullets;
+    Pool<EnemyCar> enemyCars;
+    Pool<Truck> trucks;
+    UniformGrid grid;
+    FrameArena arena; // scratch for one update step, reset when it ends
+    Rng rng;
+    int score;
+    bool gameOver;
+    Uint32 sounds;
+    Uint64 frame;
+    double roadDistance;     // pixels of road driven this run
+    double prevRoadDistance; // roadDistance before the last step
+};
+
+void update(GameState& state, float dt, Uint8 input);
+void detectCollisions(GameState& state, FrameList<HitEvent>& hits);
+void applyHits(GameState& state, const FrameList<HitEvent>& hits);
+void render(const GameState& state, float alpha);
+Uint64 hashState(const GameState& state);
+
+// Globally used textures, all drawn from one atlas when it is available
+TextureAtlas gAtlas;
 LTexture gCarTexture;
 LTexture gEnemyCarTexture;
 LTexture gTruckTexture;
 LTexture gBulletTexture;
-LTexture gBackgroundTexture;
+LTexture gBackgroundTexture; // drawn instead of the road if it fails to start
+RoadStreamer gRoad;
+bool gRoadActive = false;
 
 // Sound effects
 Mix_Chunk* gEngineSound = nullptr;
 Mix_Chunk* gShootSound = nullptr;
 Mix_Chunk* gExplosionSound = nullptr;
 
+// Who gets a mixer channel, and the ids of the effects registered with it
+VoiceManager gVoices;
+int gShootVoice = -1;
+int gExplosionVoice = -1;
+
 // Texture methods
-LTexture::LTexture() : mTexture(nullptr), mWidth(0), mHeight(0) {}
+LTexture::LTexture()
+    : mTexture(nullptr), mOwnsTexture(false), mRegion({ 0, 0, 0, 0 }), mTextureWidth(0), mTextureHeight(0), mWidth(0), mHeight(0) {}
 
 LTexture::~LTexture() {
     free();
@@ -161,6 +356,10 @@ bool LTexture::loadFromFile(std::string path) {
         } else {
             mWidth = loadedSurface->w;
             mHeight = loadedSurface->h;
+            mTextureWidth = mWidth;
+            mTextureHeight = mHeight;
+            mRegion = { 0, 0, mWidth, mHeight };
+            mOwnsTexture = true;
         }
         SDL_FreeSurface(loadedSurface);
     }
@@ -168,22 +367,52 @@ bool LTexture::loadFromFile(std::string path) {
     return mTexture != nullptr;
 }
 
+bool LTexture::loadFromAtlas(const TextureAtlas& atlas, const std::string& name) {
+    free();
+    const SDL_Rect* region = atlas.find(name);
+    if (!region || !atlas.getTexture()) {
+        std::cerr << "No image named " << name << " in the atlas!" << std::endl;
+        return false;
+    }
+    mTexture = atlas.getTexture();
+    mOwnsTexture = false;
+    mRegion = *region;
+    mTextureWidth = atlas.getWidth();
+    mTextureHeight = atlas.getHeight();
+    mWidth = region->w;
+    mHeight = region->h;
+    return true;
+}
+
 void LTexture::free() {
     if (mTexture) {
-        SDL_DestroyTexture(mTexture);
+        if (mOwnsTexture) {
+            SDL_DestroyTexture(mTexture);
+        }
         mTexture = nullptr;
+        mOwnsTexture = false;
         mWidth = 0;
         mHeight = 0;
     }
 }
 
 void LTexture::render(int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip) {
-    SDL_Rect renderQuad = { x, y, mWidth, mHeight };
+    // clip is relative to this image, which may sit anywhere in the texture
+    SDL_Rect src = mRegion;
     if (clip) {
-        renderQuad.w = clip->w;
-        renderQuad.h = clip->h;
+        src = { mRegion.x + clip->x, mRegion.y + clip->y, clip->w, clip->h };
+    }
+    SDL_Rect renderQuad = { x, y, src.w, src.h };
+    if (gSpriteBatch) {
+        if (angle == 0.0 && flip == SDL_FLIP_NONE) {
+            gSpriteBatch->add(mTexture, mTextureWidth, mTextureHeight, &src, renderQuad);
+            return;
+        }
+        // Draw what is queued first so this sprite keeps its place
+        gSpriteBatch->flush();
     }
-    SDL_RenderCopyEx(gRenderer, mTexture, clip, &renderQuad, angle, center, flip);
+    SDL_RenderCopyEx(gRenderer, mTexture, &src, &renderQuad, angle, center, flip);
+    ++gCopyCalls;
 }
 
 int LTexture::getWidth() {
@@ -194,68 +423,129 @@ int LTexture::getHeight() {
     return mHeight;
 }
 
+// Rng methods
+Rng::Rng(Uint64 seed) : mState(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+Uint32 Rng::next() {
+    mState ^= mState >> 12;
+    mState ^= mState << 25;
+    mState ^= mState >> 27;
+    return static_cast<Uint32>((mState * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+int Rng::nextInt(int n) {
+    return static_cast<int>(next() % static_cast<Uint32>(n));
+}
+
+float Rng::nextFloat() {
+    return (next() >> 8) * (1.0f / 16777216.0f);
+}
+
+Uint64 Rng::getState() const {
+    return mState;
+}
+
+// InputState methods
+InputState::InputState() : mHeld(0), mPressed(0) {}
+
+void InputState::handleEvent(SDL_Event& e) {
+    if ((e.type != SDL_KEYDOWN && e.type != SDL_KEYUP) || e.key.repeat != 0) {
+        return;
+    }
+    Uint8 bit = 0;
+    switch (e.key.keysym.sym) {
+    case SDLK_LEFT: bit = INPUT_LEFT; break;
+    case SDLK_RIGHT: bit = INPUT_RIGHT; break;
+    case SDLK_SPACE: bit = INPUT_FIRE; break;
+    }
+    if (e.type == SDL_KEYDOWN) {
+        mHeld |= bit;
+        mPressed |= bit;
+    } else if (e.type == SDL_KEYUP) {
+        mHeld &= ~bit;
+    }
+}
+
+Uint8 InputState::poll() {
+    Uint8 input = (mHeld & (INPUT_LEFT | INPUT_RIGHT)) | (mPressed & INPUT_FIRE);
+    mPressed = 0;
+    return input;
+}
+
+// Screen position between the previous and current simulation step
+static int lerpPosition(float prev, float current, float alpha) {
+    return static_cast<int>(prev + (current - prev) * alpha);
+}
+
 // Car methods
 Car::Car() : mPosX(SCREEN_WIDTH / 2 - CAR_WIDTH / 2), mPosY(SCREEN_HEIGHT - CAR_HEIGHT - 10), mVelX(0) {
+    mPrevX = mPosX;
+    mPrevY = mPosY;
+    mCollider.x = static_cast<int>(mPosX);
+    mCollider.y = static_cast<int>(mPosY);
     mCollider.w = CAR_WIDTH;
     mCollider.h = CAR_HEIGHT;
 }
 
-void Car::handleEvent(SDL_Event& e) {
-    if (e.type == SDL_KEYDOWN && e.key.repeat == 0) {
-        switch (e.key.keysym.sym) {
-        case SDLK_LEFT: mVelX = -CAR_SPEED; break;
-        case SDLK_RIGHT: mVelX = CAR_SPEED; break;
-        }
-    } else if (e.type == SDL_KEYUP && e.key.repeat == 0) {
-        if (e.key.keysym.sym == SDLK_LEFT || e.key.keysym.sym == SDLK_RIGHT) {
-            mVelX = 0;
-        }
+void Car::setInput(Uint8 input) {
+    mVelX = 0;
+    if ((input & INPUT_LEFT) && !(input & INPUT_RIGHT)) {
+        mVelX = -CAR_SPEED;
+    } else if ((input & INPUT_RIGHT) && !(input & INPUT_LEFT)) {
+        mVelX = CAR_SPEED;
     }
 }
 
-void Car::move() {
-    mPosX += mVelX;
-    mCollider.x = mPosX;
+void Car::move(float dt) {
+    mPrevX = mPosX;
+    mPosX += mVelX * dt;
     if (mPosX < 0 || mPosX + CAR_WIDTH > SCREEN_WIDTH) {
-        mPosX -= mVelX;
-        mCollider.x = mPosX;
+        mPosX -= mVelX * dt;
     }
+    mCollider.x = static_cast<int>(mPosX);
+}
+
+float Car::getVelocityX() const {
+    return mVelX;
 }
 
-void Car::render() {
-    gCarTexture.render(mPosX, mPosY);
+void Car::render(float alpha) const {
+    gCarTexture.render(lerpPosition(mPrevX, mPosX, alpha), lerpPosition(mPrevY, mPosY, alpha));
 }
 
-SDL_Rect Car::getCollider() {
+SDL_Rect Car::getCollider() const {
     return mCollider;
 }
 
 void Car::setPosition(int x, int y) {
-    mPosX = x;
-    mPosY = y;
+    mPosX = mPrevX = x;
+    mPosY = mPrevY = y;
     mCollider.x = mPosX;
     mCollider.y = mPosY;
 }
 
 // Bullet methods
-Bullet::Bullet(int x, int y) : mPosX(x), mPosY(y), mVelX(0), mVelY(-BULLET_SPEED), active(true) {
+Bullet::Bullet(int x, int y) : mPosX(x), mPosY(y), mPrevX(x), mPrevY(y), mVelX(0), mVelY(-BULLET_SPEED), active(true) {
+    mCollider.x = x;
+    mCollider.y = y;
     mCollider.w = BULLET_WIDTH;
     mCollider.h = BULLET_HEIGHT;
 }
 
-void Bullet::move() {
-    mPosY += mVelY;
-    mCollider.y = mPosY;
+void Bullet::move(float dt) {
+    mPrevY = mPosY;
+    mPosY += mVelY * dt;
+    mCollider.y = static_cast<int>(mPosY);
     if (mPosY < 0) {
         active = false;
     }
 }
 
-void Bullet::render() {
-    gBulletTexture.render(mPosX, mPosY);
+void Bullet::render(float alpha) const {
+    gBulletTexture.render(lerpPosition(mPrevX, mPosX, alpha), lerpPosition(mPrevY, mPosY, alpha));
 }
 
-SDL_Rect Bullet::getCollider() {
+SDL_Rect Bullet::getCollider() const {
     return mCollider;
 }
 
@@ -271,23 +561,28 @@ void Bullet::setActive(bool active) {
 EnemyCar::EnemyCar(int lane) : mVelY(ENEMY_CAR_SPEED), alive(true) {
     mPosX = lane * (SCREEN_WIDTH / 3) + (SCREEN_WIDTH / 6) - ENEMY_CAR_WIDTH / 2;
     mPosY = -ENEMY_CAR_HEIGHT;
+    mPrevX = mPosX;
+    mPrevY = mPosY;
+    mCollider.x = static_cast<int>(mPosX);
+    mCollider.y = static_cast<int>(mPosY);
     mCollider.w = ENEMY_CAR_WIDTH;
     mCollider.h = ENEMY_CAR_HEIGHT;
 }
 
-void EnemyCar::move() {
-    mPosY += mVelY;
-    mCollider.y = mPosY;
+void EnemyCar::move(float dt) {
+    mPrevY = mPosY;
+    mPosY += mVelY * dt;
+    mCollider.y = static_cast<int>(mPosY);
     if (mPosY > SCREEN_HEIGHT) {
         alive = false;
     }
 }
 
-void EnemyCar::render() {
-    gEnemyCarTexture.render(mPosX, mPosY);
+void EnemyCar::render(float alpha) const {
+    gEnemyCarTexture.render(lerpPosition(mPrevX, mPosX, alpha), lerpPosition(mPrevY, mPosY, alpha));
 }
 
-SDL_Rect EnemyCar::getCollider() {
+SDL_Rect EnemyCar::getCollider() const {
     return mCollider;
 }
 
@@ -300,24 +595,27 @@ void EnemyCar::setAlive(bool alive) {
 }
 
 // Truck methods
-Truck::Truck() : mPosX(SCREEN_WIDTH / 2 - TRUCK_WIDTH / 2), mPosY(-TRUCK_HEIGHT), mVelY(TRUCK_SPEED), onScreen(false) {
+Truck::Truck() : mPosX(SCREEN_WIDTH / 2 - TRUCK_WIDTH / 2), mPosY(-TRUCK_HEIGHT), mPrevX(mPosX), mPrevY(mPosY), mVelY(TRUCK_SPEED), onScreen(false) {
+    mCollider.x = static_cast<int>(mPosX);
+    mCollider.y = static_cast<int>(mPosY);
     mCollider.w = TRUCK_WIDTH;
     mCollider.h = TRUCK_HEIGHT;
 }
 
-void Truck::move() {
-    mPosY += mVelY;
-    mCollider.y = mPosY;
+void Truck::move(float dt) {
+    mPrevY = mPosY;
+    mPosY += mVelY * dt;
+    mCollider.y = static_cast<int>(mPosY);
     if (mPosY > SCREEN_HEIGHT) {
         onScreen = false;
     }
 }
 
-void Truck::render() {
-    gTruckTexture.render(mPosX, mPosY);
+void Truck::render(float alpha) const {
+    gTruckTexture.render(lerpPosition(mPrevX, mPosX, alpha), lerpPosition(mPrevY, mPosY, alpha));
 }
 
-SDL_Rect Truck::getCollider() {
+SDL_Rect Truck::getCollider() const {
     return mCollider;
 }
 
@@ -329,8 +627,238 @@ void Truck::setOnScreen(bool onScreen) {
     this->onScreen = onScreen;
 }
 
+// GameState methods
+GameState::GameState(Uint64 seed, int maxEnemyCars)
+    : bullets(MAX_BULLETS), enemyCars(maxEnemyCars), trucks(MAX_TRUCKS),
+      grid(0, GRID_ORIGIN_Y, GRID_COLUMNS, GRID_ROWS, SCREEN_WIDTH / GRID_COLUMNS, GRID_ROW_HEIGHT),
+      arena(sizeof(HitEvent) * (MAX_BULLETS + maxEnemyCars) + alignof(HitEvent)), rng(seed),
+      score(0), gameOver(false), sounds(0), frame(0),
+      roadDistance(0.0), prevRoadDistance(0.0) {
+    // A truck covers at most 2 columns x 3 rows of cells
+    grid.reserve(maxEnemyCars + MAX_TRUCKS, 6);
+}
+
+void GameState::restart() {
+    playerCar = Car();
+    bullets.clear();
+    enemyCars.clear();
+    trucks.clear();
+    arena.reset();
+    score = 0;
+    gameOver = false;
+    sounds = 0;
+    roadDistance = 0.0;
+    prevRoadDistance = 0.0;
+}
+
+// Advances the simulation by dt seconds. No SDL calls are made here, so
+// this runs the same with a window, headless, or faster than real time.
+void update(GameState& state, float dt, Uint8 input) {
+    state.sounds = 0;
+
+    state.prevRoadDistance = state.roadDistance;
+    state.roadDistance += ROAD_SPEED * dt;
+
+    state.playerCar.setInput(input);
+    state.playerCar.move(dt);
+
+    // Fire a bullet from the front of the car
+    if (input & INPUT_FIRE) {
+        SDL_Rect car = state.playerCar.getCollider();
+        if (state.bullets.spawn(car.x + car.w / 2 - Bullet::BULLET_WIDTH / 2, car.y - Bullet::BULLET_HEIGHT).isValid()) {
+            state.sounds |= SOUND_SHOOT;
+        }
+    }
+
+    // Add new enemy cars
+    if (state.rng.nextFloat() < ENEMY_SPAWN_RATE * dt) {
+        int lane = state.rng.nextInt(3);
+        state.enemyCars.spawn(lane);
+    }
+
+    // Move enemy cars
+    for (auto& car : state.enemyCars) {
+        car.move(dt);
+    }
+
+    // Move bullets
+    for (auto& bullet : state.bullets) {
+        bullet.move(dt);
+    }
+
+    // Move truck, sending a new one once the last has left the screen
+    if (state.trucks.empty()) {
+        Pool<Truck>::Handle h = state.trucks.spawn();
+        state.trucks.get(h)->setOnScreen(true);
+    }
+    for (auto& truck : state.trucks) {
+        truck.move(dt);
+    }
+
+    // Each bullet hits at most one thing; the player can touch every car
+    FrameList<HitEvent> hits(state.arena, state.bullets.capacity() + state.enemyCars.capacity());
+    detectCollisions(state, hits);
+    applyHits(state, hits);
+
+    state.enemyCars.removeIf([](const EnemyCar& car) { return !car.isAlive(); });
+    state.bullets.removeIf([](const Bullet& bullet) { return !bullet.isActive(); });
+    state.trucks.removeIf([](const Truck& truck) { return !truck.isOnScreen(); });
+
+    state.arena.reset();
+    ++state.frame;
+}
+
+// Ids stored in the grid: the pool's dense index, tagged with the pool
+const Uint32 GRID_TRUCK_BIT = 0x80000000u;
+
+// Fills hits, in detection order. Enemy cars and trucks go into the grid, then each bullet
+// and the player query only the cells they overlap, so the cost is
+// O(targets + probes + candidates) rather than O(probes * targets).
+void detectCollisions(GameState& state, FrameList<HitEvent>& hits) {
+    state.grid.clear();
+    for (std::size_t i = 0; i < state.enemyCars.size(); ++i) {
+        if (state.enemyCars[i].isAlive()) {
+            state.grid.insert(static_cast<Uint32>(i), state.enemyCars[i].getCollider());
+        }
+    }
+    for (std::size_t i = 0; i < state.trucks.size(); ++i) {
+        state.grid.insert(static_cast<Uint32>(i) | GRID_TRUCK_BIT, state.trucks[i].getCollider());
+    }
+    state.grid.build();
+
+    // A bullet stops at the first thing it hits
+    for (std::size_t i = 0; i < state.bullets.size(); ++i) {
+        SDL_Rect bulletBox = state.bullets[i].getCollider();
+        state.grid.query(bulletBox, [&](Uint32 id, const SDL_Rect& box) {
+            if (!checkCollision(bulletBox, box)) {
+                return true;
+            }
+            HitEvent hit;
+            hit.bullet = state.bullets.handleAt(i);
+            if (id & GRID_TRUCK_BIT) {
+                hit.kind = HIT_BULLET_TRUCK;
+                hit.truck = state.trucks.handleAt(id & ~GRID_TRUCK_BIT);
+            } else {
+                hit.kind = HIT_BULLET_ENEMY;
+                hit.enemyCar = state.enemyCars.handleAt(id);
+            }
+            hit.position = { bulletBox.x + bulletBox.w / 2, bulletBox.y };
+            hits.push_back(hit);
+            return false;
+        });
+    }
+
+    SDL_Rect playerBox = state.playerCar.getCollider();
+    state.grid.query(playerBox, [&](Uint32 id, const SDL_Rect& box) {
+        if (!(id & GRID_TRUCK_BIT) && checkCollision(playerBox, box)) {
+            HitEvent hit;
+            hit.kind = HIT_PLAYER_ENEMY;
+            hit.enemyCar = state.enemyCars.handleAt(id);
+            hit.position = { playerBox.x + playerBox.w / 2, playerBox.y };
+            hits.push_back(hit);
+        }
+        return true;
+    });
+}
+
+// Scoring: turns this step's hit events into kills, points and sounds
+void applyHits(GameState& state, const FrameList<HitEvent>& hits) {
+    for (const HitEvent& hit : hits) {
+        switch (hit.kind) {
+        case HIT_BULLET_ENEMY: {
+            // Two bullets can reach the same car in one step; only the first scores
+            EnemyCar* car = state.enemyCars.get(hit.enemyCar);
+            Bullet* bullet = state.bullets.get(hit.bullet);
+            if (car && car->isAlive() && bullet) {
+                car->setAlive(false);
+                bullet->setActive(false);
+                state.score += SCORE_ENEMY_CAR;
+                state.sounds |= SOUND_EXPLOSION;
+            }
+            break;
+        }
+        case HIT_BULLET_TRUCK: {
+            Bullet* bullet = state.bullets.get(hit.bullet);
+            if (bullet) {
+                bullet->setActive(false);
+                state.score += SCORE_TRUCK_HIT;
+            }
+            break;
+        }
+        case HIT_PLAYER_ENEMY:
+            state.sounds |= SOUND_EXPLOSION;
+            state.gameOver = true;
+            break;
+        }
+    }
+}
+
+// Hash of everything that decides what happens next, for checking that a
+// replay is still following the recorded run
+Uint64 hashState(const GameState& state) {
+    StateHash h;
+    h.add(state.frame);
+    h.add(state.score);
+    h.add(state.gameOver);
+    h.add(state.rng.getState());
+    h.add(state.roadDistance);
+    h.add(state.playerCar.getCollider());
+    for (const auto& car : state.enemyCars) {
+        h.add(car.getCollider());
+        h.add(car.isAlive());
+    }
+    for (const auto& bullet : state.bullets) {
+        h.add(bullet.getCollider());
+    }
+    for (const auto& truck : state.trucks) {
+        h.add(truck.getCollider());
+    }
+    return h.get();
+}
+
+// Draws the current state. Reads only; never advances the simulation.
+// alpha (0..1) is how far real time has got between the last two steps;
+// entities are drawn that far from their previous position to the current one.
+void render(const GameState& state, float alpha) {
+    // Clear screen
+    SDL_RenderClear(gRenderer);
+
+    // Render road. It draws straight away, before anything batched below.
+    if (gRoadActive) {
+        gRoad.render(state.prevRoadDistance + (state.roadDistance - state.prevRoadDistance) * alpha);
+    } else {
+        if (gSpriteBatch) gSpriteBatch->setLayer(LAYER_BACKGROUND);
+        gBackgroundTexture.render(0, 0);
+    }
+
+    // Render player car
+    if (gSpriteBatch) gSpriteBatch->setLayer(LAYER_VEHICLES);
+    state.playerCar.render(alpha);
+
+    // Render enemy cars
+    for (const auto& car : state.enemyCars) {
+        car.render(alpha);
+    }
+
+    // Render truck
+    for (const auto& truck : state.trucks) {
+        truck.render(alpha);
+    }
+
+    // Render bullets
+    if (gSpriteBatch) gSpriteBatch->setLayer(LAYER_BULLETS);
+    for (const auto& bullet : state.bullets) {
+        bullet.render(alpha);
+    }
+
+    if (gSpriteBatch) gSpriteBatch->flush();
+
+    // Update screen
+    SDL_RenderPresent(gRenderer);
+}
+
 // SDL initialization functions
-bool init() {
+bool init(Uint32 rendererFlags) {
     bool success = true;
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         std::cerr << "SDL could not initialize! SDL Error: " << SDL_GetError() << std::endl;
@@ -344,7 +872,7 @@ bool init() {
             std::cerr << "Window could not be created! SDL Error: " << SDL_GetError() << std::endl;
             success = false;
         } else {
-            gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+            gRenderer = SDL_CreateRenderer(gWindow, -1, rendererFlags);
             if (!gRenderer) {
                 std::cerr << "Renderer could not be created! SDL Error: " << SDL_GetError() << std::endl;
                 success = false;
@@ -368,23 +896,32 @@ bool init() {
 // Media loading functions
 bool loadMedia() {
     bool success = true;
-    if (!gCarTexture.loadFromFile("car.bmp")) {
+
+    // Use a prebuilt atlas if there is one, otherwise pack the sprites now
+    if (!gAtlas.load(gRenderer, "sprites.atlas")) {
+        std::vector<std::string> sprites = { "car.bmp", "enemy_car.bmp", "truck.bmp", "bullet.bmp", "background.bmp" };
+        if (!gAtlas.build(sprites) || !gAtlas.createTexture(gRenderer)) {
+            std::cerr << "Failed to build sprite atlas!" << std::endl;
+            success = false;
+        }
+    }
+    if (!gCarTexture.loadFromAtlas(gAtlas, "car")) {
         std::cerr << "Failed to load car texture!" << std::endl;
         success = false;
     }
-    if (!gEnemyCarTexture.loadFromFile("enemy_car.bmp")) {
+    if (!gEnemyCarTexture.loadFromAtlas(gAtlas, "enemy_car")) {
         std::cerr << "Failed to load enemy car texture!" << std::endl;
         success = false;
     }
-    if (!gTruckTexture.loadFromFile("truck.bmp")) {
+    if (!gTruckTexture.loadFromAtlas(gAtlas, "truck")) {
         std::cerr << "Failed to load truck texture!" << std::endl;
         success = false;
     }
-    if (!gBulletTexture.loadFromFile("bullet.bmp")) {
+    if (!gBulletTexture.loadFromAtlas(gAtlas, "bullet")) {
         std::cerr << "Failed to load bullet texture!" << std::endl;
         success = false;
     }
-    if (!gBackgroundTexture.loadFromFile("background.bmp")) {
+    if (!gBackgroundTexture.loadFromAtlas(gAtlas, "background")) {
         std::cerr << "Failed to load background texture!" << std::endl;
         success = false;
     }
@@ -403,11 +940,46 @@ bool loadMedia() {
         std::cerr << "Failed to load explosion sound effect! SDL_mixer Error: " << Mix_GetError() << std::endl;
         success = false;
     }
+    gRoadActive = gRoad.init(gRenderer, SCREEN_WIDTH, SCREEN_HEIGHT, ROAD_STRIP_HEIGHT, ROAD_RING_SIZE, 0x5E7A11ull);
+    if (!gRoadActive) {
+        std::cerr << "Failed to start road streaming, using the static background" << std::endl;
+    }
+    if (success && !setupVoices()) {
+        std::cerr << "Failed to set up mixer voices!" << std::endl;
+        success = false;
+    }
     return success;
 }
 
+// Splits the mixer channels into groups and registers the effects
+bool setupVoices() {
+    if (!gVoices.init(MIXER_CHANNELS)) {
+        return false;
+    }
+    int engineGroup = gVoices.addGroup(ENGINE_CHANNELS);
+    int weaponGroup = gVoices.addGroup(WEAPON_CHANNELS);
+    int explosionGroup = gVoices.addGroup(EXPLOSION_CHANNELS);
+    gShootVoice = gVoices.addSound(gShootSound, weaponGroup, PRIORITY_SHOOT, 40, 3);
+    gExplosionVoice = gVoices.addSound(gExplosionSound, explosionGroup, PRIORITY_EXPLOSION, 30, 4);
+    return gVoices.startEngine(gEngineSound, engineGroup);
+}
+
+// Plays the sounds an update step asked for and follows the car's speed
+// with the engine pitch
+void playSounds(const GameState& state, Uint32 sounds, Uint32 nowMs) {
+    if (sounds & SOUND_SHOOT) {
+        gVoices.play(gShootVoice, nowMs);
+    }
+    if (sounds & SOUND_EXPLOSION) {
+        gVoices.play(gExplosionVoice, nowMs);
+    }
+    float speed = std::fabs(state.playerCar.getVelocityX()) / CAR_SPEED;
+    gVoices.setEnginePitch(ENGINE_PITCH_IDLE + (ENGINE_PITCH_FULL - ENGINE_PITCH_IDLE) * speed);
+}
+
 // Clean up
 void close() {
+    gVoices.stopAll();
     Mix_FreeChunk(gEngineSound);
     Mix_FreeChunk(gShootSound);
     Mix_FreeChunk(gExplosionSound);
@@ -419,6 +991,9 @@ void close() {
     gTruckTexture.free();
     gBulletTexture.free();
     gBackgroundTexture.free();
+    gRoad.shutdown();
+    gRoadActive = false;
+    gAtlas.free();
     Mix_Quit();
     IMG_Quit();
     SDL_Quit();
@@ -438,8 +1013,442 @@ bool checkCollision(SDL_Rect a, SDL_Rect b) {
     return !(leftA > rightB || rightA < leftB || topA > bottomB || bottomA < topB);
 }
 
+// Scripted driver so headless runs exercise steering and shooting
+class Autopilot {
+public:
+    explicit Autopilot(Uint64 seed) : mRng(seed), mSteer(0), mHoldFrames(0), mFrame(0) {}
+
+    Uint8 next() {
+        if (mHoldFrames <= 0) {
+            const Uint8 choices[] = { 0, INPUT_LEFT, INPUT_RIGHT };
+            mSteer = choices[mRng.nextInt(3)];
+            mHoldFrames = 30 + mRng.nextInt(60);
+        }
+        --mHoldFrames;
+        ++mFrame;
+        return mSteer | ((mFrame % 8 == 0) ? INPUT_FIRE : 0);
+    }
+
+private:
+    Rng mRng;
+    Uint8 mSteer;
+    int mHoldFrames;
+    int mFrame;
+};
+
+// Runs the simulation with no window, renderer or audio device and prints
+// timing, entity and allocation figures. SDL is never initialised. With a
+// record path the autopilot's inputs are saved as a replay.
+int runHeadless(int frames, Uint64 seed, const std::string& recordPath) {
+    const float dt = SIM_STEP;
+    const int warmupFrames = 120;
+
+    GameState state(seed);
+    Autopilot autopilot(seed ^ 0xA5A5A5A5A5A5A5A5ull);
+    Replay replay;
+    bool recording = !recordPath.empty();
+    if (recording) {
+        replay.start(seed, REPLAY_HASH_INTERVAL);
+    }
+
+    std::size_t peakEnemyCars = 0;
+    std::size_t peakBullets = 0;
+    std::size_t peakTrucks = 0;
+    int crashes = 0;
+    long long totalScore = 0;
+    long long maxFrameNs = 0;
+    std::size_t allocsAtStart = allocationCount();
+    std::size_t allocsAfterWarmup = allocsAtStart;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        if (i == warmupFrames) {
+            allocsAfterWarmup = allocationCount();
+        }
+        auto frameStart = std::chrono::steady_clock::now();
+
+        Uint8 input = autopilot.next();
+        update(state, dt, input);
+        if (recording) {
+            replay.recordInput(input);
+            if (state.frame % REPLAY_HASH_INTERVAL == 0) {
+                replay.recordHash(hashState(state));
+            }
+        }
+        if (state.gameOver) {
+            ++crashes;
+            totalScore += state.score;
+            state.restart();
+        }
+
+        auto frameEnd = std::chrono::steady_clock::now();
+        long long frameNs = std::chrono::duration_cast<std::chrono::nanoseconds>(frameEnd - frameStart).count();
+        if (frameNs > maxFrameNs) {
+            maxFrameNs = frameNs;
+        }
+        if (state.enemyCars.size() > peakEnemyCars) peakEnemyCars = state.enemyCars.size();
+        if (state.bullets.size() > peakBullets) peakBullets = state.bullets.size();
+        if (state.trucks.size() > peakTrucks) peakTrucks = state.trucks.size();
+    }
+    auto end = std::chrono::steady_clock::now();
+    totalScore += state.score;
+
+    long long totalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::size_t allocsEnd = allocationCount();
+
+    std::cout << "frames:            " << frames << std::endl;
+    std::cout << "seed:              " << seed << std::endl;
+    std::cout << "ns/frame (avg):    " << (frames > 0 ? totalNs / frames : 0) << std::endl;
+    std::cout << "ns/frame (max):    " << maxFrameNs << std::endl;
+    std::cout << "enemy cars (live/peak/cap): " << state.enemyCars.size() << "/" << peakEnemyCars << "/" << state.enemyCars.capacity() << std::endl;
+    std::cout << "bullets (live/peak/cap):    " << state.bullets.size() << "/" << peakBullets << "/" << state.bullets.capacity() << std::endl;
+    std::cout << "trucks (live/peak/cap):     " << state.trucks.size() << "/" << peakTrucks << "/" << state.trucks.capacity() << std::endl;
+    std::cout << "frame arena (peak/cap):     " << state.arena.getPeak() << "/" << state.arena.getCapacity()
+              << " bytes, " << state.arena.getFailedAllocations() << " failed" << std::endl;
+    std::cout << "crashes:           " << crashes << std::endl;
+    std::cout << "score:             " << totalScore << std::endl;
+    std::cout << "allocations:       " << (allocsEnd - allocsAtStart) << std::endl;
+    std::cout << "allocations after warm-up: " << (frames > warmupFrames ? allocsEnd - allocsAfterWarmup : 0) << std::endl;
+    if (recording) {
+        if (!replay.save(recordPath)) {
+            return 1;
+        }
+        std::cout << "recorded " << replay.getStepCount() << " steps (" << replay.getRunCount() << " input runs) to " << recordPath << std::endl;
+    }
+    return 0;
+}
+
+// Plays a replay back with no window as fast as the simulation will go.
+// Game overs restart the run, as they do in --headless. With verify, every
+// recorded state hash is checked and the first divergence is reported.
+int runReplay(const std::string& path, bool verify) {
+    Replay replay;
+    if (!replay.load(path)) {
+        return 1;
+    }
+
+    GameState state(replay.getSeed());
+    Uint32 interval = replay.getHashInterval();
+    std::size_t hashesChecked = 0;
+    long long maxStepNs = 0;
+    Uint64 divergedAt = 0;
+    int crashes = 0;
+
+    Uint8 input = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (replay.nextInput(input)) {
+        auto stepStart = std::chrono::steady_clock::now();
+        update(state, SIM_STEP, input);
+        long long stepNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - stepStart).count();
+        if (stepNs > maxStepNs) {
+            maxStepNs = stepNs;
+        }
+
+        if (verify && interval > 0 && state.frame % interval == 0) {
+            std::size_t i = state.frame / interval - 1;
+            if (i < replay.getHashCount()) {
+                ++hashesChecked;
+                if (hashState(state) != replay.getHash(i)) {
+                    divergedAt = state.frame;
+                    break;
+                }
+            }
+        }
+        if (state.gameOver) {
+            ++crashes;
+            state.restart();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    long long totalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double simSeconds = state.frame * SIM_STEP;
+    double wallSeconds = totalNs / 1e9;
+
+    std::cout << "replay:            " << path << std::endl;
+    std::cout << "seed:              " << replay.getSeed() << std::endl;
+    std::cout << "steps:             " << state.frame << "/" << replay.getStepCount() << std::endl;
+    std::cout << "ns/step (avg):     " << (state.frame > 0 ? totalNs / static_cast<long long>(state.frame) : 0) << std::endl;
+    std::cout << "ns/step (max):     " << maxStepNs << std::endl;
+    std::cout << "speed:             " << (wallSeconds > 0.0 ? simSeconds / wallSeconds : 0.0) << "x real time" << std::endl;
+    std::cout << "crashes:           " << crashes << std::endl;
+    if (verify) {
+        std::cout << "hashes checked:    " << hashesChecked << "/" << replay.getHashCount() << std::endl;
+        if (divergedAt > 0) {
+            std::cout << "DIVERGED at step " << divergedAt << std::endl;
+            return 1;
+        }
+        std::cout << "no divergence" << std::endl;
+    }
+    return 0;
+}
+
+// Draws a static scene of many enemy cars on the software renderer and
+// reports frame time and draw calls, with or without sprite batching.
+// Run with SDL_VIDEODRIVER=dummy SDL_AUDIODRIVER=dummy on a machine
+// without a display.
+int runStress(int enemyCars, int frames, bool batched) {
+    if (!init(SDL_RENDERER_SOFTWARE)) {
+        std::cerr << "Failed to initialize!" << std::endl;
+        close();
+        return 1;
+    }
+    if (!loadMedia()) {
+        std::cerr << "Failed to load media!" << std::endl;
+        close();
+        return 1;
+    }
+
+    // Room for every car plus the player, truck and background
+    FrameArena frameArena(RENDER_ARENA_SIZE + (enemyCars + 8) * 64);
+    SpriteBatch batch;
+    batch.setRenderer(gRenderer);
+    batch.setArena(&frameArena, enemyCars + 8);
+    gSpriteBatch = batched ? &batch : nullptr;
+
+    // Spread the cars down the screen by moving each for a random time
+    GameState state(1, enemyCars);
+    for (int i = 0; i < enemyCars; ++i) {
+        Pool<EnemyCar>::Handle h = state.enemyCars.spawn(state.rng.nextInt(3));
+        state.enemyCars.get(h)->move(state.rng.nextFloat() * SCREEN_HEIGHT / ENEMY_CAR_SPEED);
+    }
+
+    int drawCalls = 0;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < frames; ++i) {
+        gCopyCalls = 0;
+        render(state, 1.0f);
+        frameArena.reset();
+        drawCalls = gCopyCalls + (batched ? batch.getLastDrawCalls() : 0);
+    }
+    Uint64 end = SDL_GetPerformanceCounter();
+    double msPerFrame = (end - start) * 1000.0 / SDL_GetPerformanceFrequency() / (frames > 0 ? frames : 1);
+
+    std::cout << "enemy cars:  " << state.enemyCars.size() << std::endl;
+    std::cout << "batching:    " << (batched ? "on" : "off") << std::endl;
+    std::cout << "ms/frame:    " << msPerFrame << std::endl;
+    std::cout << "draw calls:  " << drawCalls << std::endl;
+
+    gSpriteBatch = nullptr;
+    close();
+    return 0;
+}
+
+// Packs every image in dir into OUT.png plus OUT.atlas metadata
+int runPackAtlas(const std::string& dir, const std::string& outPrefix) {
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        std::cerr << "SDL_image could not initialize! SDL_image Error: " << IMG_GetError() << std::endl;
+        return 1;
+    }
+    TextureAtlas atlas;
+    bool success = atlas.buildFromDirectory(dir) && atlas.save(outPrefix + ".png", outPrefix + ".atlas");
+    if (success) {
+        std::cout << "Packed " << dir << " into " << outPrefix << ".png (" << atlas.getWidth() << "x" << atlas.getHeight() << ")" << std::endl;
+    }
+    atlas.free();
+    IMG_Quit();
+    return success ? 0 : 1;
+}
+
+// Times bullet-vs-enemy overlap tests over random boxes, brute force
+// against the grid, and checks that both find the same number of hits.
+int runCollisionBench(int bullets, int enemyCars, int passes) {
+    Rng rng(1);
+    std::vector<SDL_Rect> bulletBoxes(bullets);
+    std::vector<SDL_Rect> enemyBoxes(enemyCars);
+    for (SDL_Rect& box : bulletBoxes) {
+        box = { rng.nextInt(SCREEN_WIDTH), rng.nextInt(SCREEN_HEIGHT), Bullet::BULLET_WIDTH, Bullet::BULLET_HEIGHT };
+    }
+    for (SDL_Rect& box : enemyBoxes) {
+        box = { rng.nextInt(SCREEN_WIDTH), rng.nextInt(SCREEN_HEIGHT), ENEMY_CAR_WIDTH, ENEMY_CAR_HEIGHT };
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long long bruteHits = 0;
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const SDL_Rect& b : bulletBoxes) {
+            for (const SDL_Rect& e : enemyBoxes) {
+                if (checkCollision(b, e)) {
+                    ++bruteHits;
+                }
+            }
+        }
+    }
+    auto mid = std::chrono::steady_clock::now();
+
+    UniformGrid grid(0, GRID_ORIGIN_Y, GRID_COLUMNS, GRID_ROWS, SCREEN_WIDTH / GRID_COLUMNS, GRID_ROW_HEIGHT);
+    long long gridHits = 0;
+    for (int pass = 0; pass < passes; ++pass) {
+        grid.clear();
+        for (std::size_t i = 0; i < enemyBoxes.size(); ++i) {
+            grid.insert(static_cast<Uint32>(i), enemyBoxes[i]);
+        }
+        grid.build();
+        for (const SDL_Rect& b : bulletBoxes) {
+            grid.query(b, [&](Uint32, const SDL_Rect& e) {
+                if (checkCollision(b, e)) {
+                    ++gridHits;
+                }
+                return true;
+            });
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double bruteUs = std::chrono::duration<double, std::micro>(mid - start).count() / passes;
+    double gridUs = std::chrono::duration<double, std::micro>(end - mid).count() / passes;
+    std::cout << bullets << " bullets x " << enemyCars << " enemy cars, " << passes << " passes" << std::endl;
+    std::cout << "brute force: " << bruteUs << " us/pass, " << bruteHits / passes << " hits" << std::endl;
+    std::cout << "grid:        " << gridUs << " us/pass, " << gridHits / passes << " hits" << std::endl;
+    return bruteHits == gridHits ? 0 : 1;
+}
+
+// Fires 100 explosion requests every 10 ms for 3 seconds through the dummy
+// audio driver (unless SDL_AUDIODRIVER says otherwise) and reports how many
+// voices were mixed and the process CPU time that took. With managed set
+// to false every request gets its own channel, as Mix_PlayChannel(-1, ...)
+// did before, for comparison.
+int runAudioBench(bool managed) {
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+        std::cerr << "SDL could not initialize! SDL Error: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+        std::cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << std::endl;
+        SDL_Quit();
+        return 1;
+    }
+
+    // Use the real explosion if it is around, otherwise half a second of
+    // decaying noise so the benchmark runs without any assets
+    std::vector<Sint16> noise;
+    Mix_Chunk* explosion = Mix_LoadWAV("explosion.wav");
+    if (!explosion) {
+        int frequency;
+        Uint16 format;
+        int channels;
+        Mix_QuerySpec(&frequency, &format, &channels);
+        Rng rng(1);
+        noise.resize(static_cast<std::size_t>(frequency / 2) * channels);
+        for (std::size_t i = 0; i < noise.size(); ++i) {
+            float decay = 1.0f - static_cast<float>(i) / noise.size();
+            noise[i] = static_cast<Sint16>((rng.nextFloat() * 2.0f - 1.0f) * 8000.0f * decay);
+        }
+        explosion = Mix_QuickLoad_RAW(reinterpret_cast<Uint8*>(noise.data()), static_cast<Uint32>(noise.size() * sizeof(Sint16)));
+    }
+
+    VoiceManager voices;
+    int sound = -1;
+    if (managed) {
+        voices.init(MIXER_CHANNELS);
+        voices.addGroup(ENGINE_CHANNELS);
+        voices.addGroup(WEAPON_CHANNELS);
+        int explosionGroup = voices.addGroup(EXPLOSION_CHANNELS);
+        sound = voices.addSound(explosion, explosionGroup, PRIORITY_EXPLOSION, 30, 4);
+    } else {
+        Mix_AllocateChannels(256);
+    }
+
+    const int ticks = 300;
+    const int requestsPerTick = 100;
+    int started = 0;
+    int peakVoices = 0;
+    std::clock_t cpuStart = std::clock();
+    Uint32 wallStart = SDL_GetTicks();
+    for (int t = 0; t < ticks; ++t) {
+        for (int k = 0; k < requestsPerTick; ++k) {
+            int channel = managed ? voices.play(sound, SDL_GetTicks()) : Mix_PlayChannel(-1, explosion, 0);
+            if (channel >= 0) {
+                ++started;
+            }
+        }
+        int playing = Mix_Playing(-1);
+        if (playing > peakVoices) {
+            peakVoices = playing;
+        }
+        SDL_Delay(10);
+    }
+    double cpuMs = (std::clock() - cpuStart) * 1000.0 / CLOCKS_PER_SEC;
+    Uint32 wallMs = SDL_GetTicks() - wallStart;
+
+    std::cout << "voice manager:  " << (managed ? "on" : "off") << std::endl;
+    std::cout << "requests:       " << ticks * requestsPerTick << std::endl;
+    std::cout << "voices started: " << started << std::endl;
+    if (managed) {
+        const VoiceManager::Stats& stats = voices.getStats();
+        std::cout << "stolen:         " << stats.stolen << std::endl;
+        std::cout << "rate limited:   " << stats.rateLimited << std::endl;
+        std::cout << "rejected:       " << stats.rejected << std::endl;
+    }
+    std::cout << "peak voices:    " << peakVoices << std::endl;
+    std::cout << "CPU ms per s:   " << (wallMs > 0 ? cpuMs * 1000.0 / wallMs : 0.0) << std::endl;
+
+    if (managed) {
+        voices.stopAll();
+    } else {
+        Mix_HaltChannel(-1);
+    }
+    Mix_FreeChunk(explosion);
+    Mix_CloseAudio();
+    Mix_Quit();
+    SDL_Quit();
+    return 0;
+}
+
 // Main function
 int main(int argc, char* args[]) {
+    bool headless = false;
+    int frames = 0;
+    Uint64 seed = 0;
+    bool haveSeed = false;
+    int stressCars = 0;
+    bool batched = true;
+    std::string recordPath;
+    std::string replayPath;
+    bool verify = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(args[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(args[i], "--stress") == 0 && i + 1 < argc) {
+            stressCars = std::atoi(args[++i]);
+        } else if (std::strcmp(args[i], "--bench-collision") == 0) {
+            return runCollisionBench(1000, 1000, 100);
+        } else if (std::strcmp(args[i], "--bench-audio") == 0) {
+            return runAudioBench(!(i + 1 < argc && std::strcmp(args[i + 1], "--no-voice-manager") == 0));
+        } else if (std::strcmp(args[i], "--no-batch") == 0) {
+            batched = false;
+        } else if (std::strcmp(args[i], "--pack-atlas") == 0 && i + 2 < argc) {
+            std::string dir = args[++i];
+            std::string outPrefix = args[++i];
+            return runPackAtlas(dir, outPrefix);
+        } else if (std::strcmp(args[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = args[++i];
+        } else if (std::strcmp(args[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = args[++i];
+        } else if (std::strcmp(args[i], "--verify") == 0) {
+            verify = true;
+        } else if (std::strcmp(args[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(args[++i]);
+        } else if (std::strcmp(args[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(args[++i], nullptr, 10);
+            haveSeed = true;
+        } else {
+            std::cerr << "Usage: " << args[0] << " [--headless] [--frames N] [--seed S] [--stress CARS] [--no-batch] [--pack-atlas DIR OUT] [--bench-collision] [--bench-audio [--no-voice-manager]] [--record FILE] [--replay FILE [--verify]]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!replayPath.empty()) {
+        return runReplay(replayPath, verify);
+    }
+    if (headless) {
+        return runHeadless(frames > 0 ? frames : 36000, haveSeed ? seed : 1, recordPath);
+    }
+    if (stressCars > 0) {
+        return runStress(stressCars, frames > 0 ? frames : 300, batched);
+    }
+
     if (!init()) {
         std::cerr << "Failed to initialize!" << std::endl;
     } else {
@@ -448,78 +1457,69 @@ int main(int argc, char* args[]) {
         } else {
             bool quit = false;
             SDL_Event e;
-            Car playerCar;
-            std::vector<Bullet> bullets;
-            std::vector<EnemyCar> enemyCars;
-            Truck truck;
-            int score = 0;
-
+            InputState input;
+            Uint64 runSeed = haveSeed ? seed : SDL_GetPerformanceCounter();
+            GameState state(runSeed);
+            Replay replay;
+            if (!recordPath.empty()) {
+                replay.start(runSeed, REPLAY_HASH_INTERVAL);
+            }
+            FrameArena frameArena(RENDER_ARENA_SIZE);
+            SpriteBatch batch;
+            batch.setRenderer(gRenderer);
+            batch.setArena(&frameArena, MAX_SPRITES_PER_FRAME);
+            gSpriteBatch = batched ? &batch : nullptr;
+
+            Uint64 lastCounter = SDL_GetPerformanceCounter();
+            float accumulator = 0.0f;
             while (!quit) {
                 while (SDL_PollEvent(&e) != 0) {
                     if (e.type == SDL_QUIT) {
                         quit = true;
                     }
-                    playerCar.handleEvent(e);
+                    input.handleEvent(e);
                 }
 
-                playerCar.move();
-
-                // Add new enemy cars
-                if (rand() % 100 < 2) {
-                    int lane = rand() % 3;
-                    enemyCars.push_back(EnemyCar(lane));
+                Uint64 counter = SDL_GetPerformanceCounter();
+                float frameTime = static_cast<float>(counter - lastCounter) / SDL_GetPerformanceFrequency();
+                lastCounter = counter;
+                if (frameTime > MAX_FRAME_TIME) {
+                    frameTime = MAX_FRAME_TIME;
                 }
-
-                // Move enemy cars
-                for (auto& car : enemyCars) {
-                    car.move();
-                    if (checkCollision(playerCar.getCollider(), car.getCollider())) {
-                        Mix_PlayChannel(-1, gExplosionSound, 0);
-                        quit = true;
+                accumulator += frameTime;
+
+                // Run as many fixed steps as real time asks for
+                Uint32 sounds = 0;
+                int steps = 0;
+                while (accumulator >= SIM_STEP && steps < MAX_STEPS_PER_FRAME && !state.gameOver) {
+                    Uint8 bits = input.poll();
+                    update(state, SIM_STEP, bits);
+                    if (!recordPath.empty()) {
+                        replay.recordInput(bits);
+                        if (state.frame % REPLAY_HASH_INTERVAL == 0) {
+                            replay.recordHash(hashState(state));
+                        }
                     }
+                    sounds |= state.sounds;
+                    accumulator -= SIM_STEP;
+                    ++steps;
                 }
-
-                // Move bullets
-                for (auto it = bullets.begin(); it != bullets.end();) {
-                    it->move();
-                    if (!it->isActive()) {
-                        it = bullets.erase(it);
-                    } else {
-                        ++it;
-                    }
+                if (steps == MAX_STEPS_PER_FRAME) {
+                    // Too far behind to catch up; drop the backlog
+                    accumulator = 0.0f;
                 }
 
-                // Move and render truck
-                if (!truck.isOnScreen()) {
-                    truck = Truck();
-                    truck.setOnScreen(true);
+                playSounds(state, sounds, SDL_GetTicks());
+                if (state.gameOver) {
+                    quit = true;
                 }
-                truck.move();
-
-                // Clear screen
-                SDL_RenderClear(gRenderer);
-
-                // Render background
-                gBackgroundTexture.render(0, 0);
 
-                // Render player car
-                playerCar.render();
-
-                // Render enemy cars
-                for (auto& car : enemyCars) {
-                    car.render();
-                }
-
-                // Render truck
-                truck.render();
-
-                // Render bullets
-                for (auto& bullet : bullets) {
-                    bullet.render();
-                }
-
-                // Update screen
-                SDL_RenderPresent(gRenderer);
+                render(state, accumulator / SIM_STEP);
+                frameArena.reset();
+            }
+            gSpriteBatch = nullptr;
+            if (!recordPath.empty() && replay.save(recordPath)) {
+                std::cout << "Recorded " << replay.getStepCount() << " steps to " << recordPath << std::endl;
             }
         }
     }
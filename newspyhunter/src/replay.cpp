@@ -0,0 +1,206 @@
+#include "replay.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const char REPLAY_MAGIC[4] = { 'S', 'P', 'Y', 'R' };
+
+// Little-endian helpers
+static void writeU32(std::ostream& out, Uint32 v) {
+    unsigned char b[4] = { Uint8(v), Uint8(v >> 8), Uint8(v >> 16), Uint8(v >> 24) };
+    out.write(reinterpret_cast<const char*>(b), 4);
+}
+
+static void writeU64(std::ostream& out, Uint64 v) {
+    writeU32(out, Uint32(v));
+    writeU32(out, Uint32(v >> 32));
+}
+
+static bool readU32(std::istream& in, Uint32& v) {
+    unsigned char b[4];
+    if (!in.read(reinterpret_cast<char*>(b), 4)) {
+        return false;
+    }
+    v = Uint32(b[0]) | Uint32(b[1]) << 8 | Uint32(b[2]) << 16 | Uint32(b[3]) << 24;
+    return true;
+}
+
+static bool readU64(std::istream& in, Uint64& v) {
+    Uint32 lo, hi;
+    if (!readU32(in, lo) || !readU32(in, hi)) {
+        return false;
+    }
+    v = Uint64(lo) | Uint64(hi) << 32;
+    return true;
+}
+
+Replay::Replay() : mSeed(0), mHashInterval(0), mSteps(0), mRun(0), mRunStep(0) {}
+
+void Replay::start(Uint64 seed, Uint32 hashInterval) {
+    mSeed = seed;
+    mHashInterval = hashInterval;
+    mSteps = 0;
+    mRuns.clear();
+    mHashes.clear();
+    rewind();
+}
+
+void Replay::recordInput(Uint8 input) {
+    if (!mRuns.empty() && mRuns.back().input == input) {
+        ++mRuns.back().length;
+    } else {
+        mRuns.push_back({ input, 1 });
+    }
+    ++mSteps;
+}
+
+void Replay::recordHash(Uint64 hash) {
+    mHashes.push_back(hash);
+}
+
+bool Replay::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Unable to write replay " << path << std::endl;
+        return false;
+    }
+    out.write(REPLAY_MAGIC, 4);
+    writeU32(out, VERSION);
+    writeU64(out, mSeed);
+    writeU32(out, mHashInterval);
+    writeU32(out, mSteps);
+    writeU32(out, static_cast<Uint32>(mRuns.size()));
+    for (const Run& run : mRuns) {
+        out.put(static_cast<char>(run.input));
+        Uint32 length = run.length;
+        do {
+            Uint8 byte = length & 0x7F;
+            length >>= 7;
+            out.put(static_cast<char>(length ? byte | 0x80 : byte));
+        } while (length);
+    }
+    writeU32(out, static_cast<Uint32>(mHashes.size()));
+    for (Uint64 hash : mHashes) {
+        writeU64(out, hash);
+    }
+    if (!out) {
+        std::cerr << "Failed writing replay " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Replay::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Unable to open replay " << path << std::endl;
+        return false;
+    }
+    char magic[4];
+    Uint32 version = 0;
+    if (!in.read(magic, 4) || std::memcmp(magic, REPLAY_MAGIC, 4) != 0 || !readU32(in, version)) {
+        std::cerr << path << " is not a replay file" << std::endl;
+        return false;
+    }
+    if (version != VERSION) {
+        std::cerr << path << ": unsupported replay version " << version << std::endl;
+        return false;
+    }
+
+    Uint64 seed = 0;
+    Uint32 hashInterval = 0, steps = 0, runCount = 0, hashCount = 0;
+    if (!readU64(in, seed) || !readU32(in, hashInterval) || !readU32(in, steps) || !readU32(in, runCount)) {
+        std::cerr << path << ": truncated replay header" << std::endl;
+        return false;
+    }
+    start(seed, hashInterval);
+
+    for (Uint32 i = 0; i < runCount; ++i) {
+        int input = in.get();
+        Uint32 length = 0;
+        int shift = 0;
+        int byte;
+        do {
+            byte = in.get();
+            if (byte == EOF) {
+                std::cerr << path << ": truncated input run " << i << std::endl;
+                return false;
+            }
+            // The fifth byte holds the top 4 bits and must be the last
+            if (shift == 28 && byte > 0x0F) {
+                std::cerr << path << ": input run " << i << " is longer than 32 bits" << std::endl;
+                return false;
+            }
+            length |= Uint32(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        if (input == EOF) {
+            std::cerr << path << ": truncated input run " << i << std::endl;
+            return false;
+        }
+        mRuns.push_back({ static_cast<Uint8>(input), length });
+        mSteps += length;
+    }
+    if (mSteps != steps) {
+        std::cerr << path << ": input runs cover " << mSteps << " steps, header says " << steps << std::endl;
+        return false;
+    }
+
+    if (!readU32(in, hashCount)) {
+        std::cerr << path << ": missing state hashes" << std::endl;
+        return false;
+    }
+    // Read one at a time rather than sized up front, so a corrupt count
+    // runs into the end of the file instead of a huge allocation
+    for (Uint32 i = 0; i < hashCount; ++i) {
+        Uint64 hash = 0;
+        if (!readU64(in, hash)) {
+            std::cerr << path << ": truncated state hash " << i << std::endl;
+            return false;
+        }
+        mHashes.push_back(hash);
+    }
+    return true;
+}
+
+void Replay::rewind() {
+    mRun = 0;
+    mRunStep = 0;
+}
+
+bool Replay::nextInput(Uint8& input) {
+    while (mRun < mRuns.size() && mRunStep >= mRuns[mRun].length) {
+        ++mRun;
+        mRunStep = 0;
+    }
+    if (mRun >= mRuns.size()) {
+        return false;
+    }
+    input = mRuns[mRun].input;
+    ++mRunStep;
+    return true;
+}
+
+Uint64 Replay::getSeed() const {
+    return mSeed;
+}
+
+Uint32 Replay::getHashInterval() const {
+    return mHashInterval;
+}
+
+Uint32 Replay::getStepCount() const {
+    return mSteps;
+}
+
+std::size_t Replay::getRunCount() const {
+    return mRuns.size();
+}
+
+std::size_t Replay::getHashCount() const {
+    return mHashes.size();
+}
+
+Uint64 Replay::getHash(std::size_t i) const {
+    return mHashes[i];
+}
@@ -0,0 +1,195 @@
+#include "road.h"
+#include <iostream>
+
+// Road colours (ARGB8888)
+const Uint32 COLOR_GRASS = 0xFF2E7D32;
+const Uint32 COLOR_GRASS_DARK = 0xFF1B5E20;
+const Uint32 COLOR_ASPHALT = 0xFF424242;
+const Uint32 COLOR_CURB_RED = 0xFFC62828;
+const Uint32 COLOR_CURB_WHITE = 0xFFEEEEEE;
+const Uint32 COLOR_LINE = 0xFFFFFFFF;
+
+// Road layout in pixels
+const int SHOULDER_WIDTH = 12;
+const int CURB_WIDTH = 6;
+const int CURB_PERIOD = 32;
+const int LINE_WIDTH = 4;
+const int DASH_LENGTH = 40;
+const int DASH_PERIOD = 80;
+const int LANES = 3;
+
+// splitmix64: cheap, well mixed hash of a strip number
+static Uint64 hashStrip(Uint64 seed, long long index) {
+    Uint64 z = seed + static_cast<Uint64>(index) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+RoadStreamer::RoadStreamer()
+    : mRenderer(nullptr), mWidth(0), mScreenHeight(0), mStripHeight(0), mSeed(0), mMisses(0),
+      mFirstNeeded(0), mQuit(false) {}
+
+RoadStreamer::~RoadStreamer() {
+    shutdown();
+}
+
+bool RoadStreamer::init(SDL_Renderer* renderer, int width, int screenHeight, int stripHeight, int ringSize, Uint64 seed) {
+    shutdown();
+    mRenderer = renderer;
+    mWidth = width;
+    mScreenHeight = screenHeight;
+    mStripHeight = stripHeight;
+    mSeed = seed;
+    mMisses = 0;
+    mFirstNeeded = 0;
+    mQuit = false;
+
+    mSlots.resize(ringSize);
+    for (Slot& slot : mSlots) {
+        slot.index = -1;
+        slot.state = SLOT_EMPTY;
+        slot.pixels.assign(static_cast<std::size_t>(width) * stripHeight, 0);
+        slot.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, stripHeight);
+        if (!slot.texture) {
+            std::cerr << "Unable to create road strip texture! SDL Error: " << SDL_GetError() << std::endl;
+            shutdown();
+            return false;
+        }
+    }
+
+    mWorker = std::thread(&RoadStreamer::workerLoop, this);
+    return true;
+}
+
+void RoadStreamer::shutdown() {
+    if (mWorker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQuit = true;
+        }
+        mWake.notify_all();
+        mWorker.join();
+    }
+    for (Slot& slot : mSlots) {
+        if (slot.texture) {
+            SDL_DestroyTexture(slot.texture);
+        }
+    }
+    mSlots.clear();
+}
+
+// Fills the ring with the strips from mFirstNeeded onwards, oldest first,
+// then sleeps until the camera moves on. Any slot not holding its strip is
+// refilled, so strips left from further along the road (e.g. after the
+// distance is reset) are replaced too.
+void RoadStreamer::workerLoop() {
+    const long long ring = static_cast<long long>(mSlots.size());
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mQuit) {
+        long long wanted = -1;
+        for (long long k = mFirstNeeded; k < mFirstNeeded + ring; ++k) {
+            Slot& slot = mSlots[k % ring];
+            if (slot.index != k) {
+                wanted = k;
+                break;
+            }
+        }
+        if (wanted < 0) {
+            mWake.wait(lock);
+            continue;
+        }
+
+        Slot& slot = mSlots[wanted % ring];
+        slot.index = wanted;
+        slot.state = SLOT_GENERATING;
+        lock.unlock();
+        generateStrip(wanted, slot.pixels.data());
+        lock.lock();
+        slot.state = SLOT_READY;
+    }
+}
+
+void RoadStreamer::generateStrip(long long index, Uint32* pixels) const {
+    Uint64 h = hashStrip(mSeed, index);
+    // Every few strips the verge changes shade so movement is visible
+    Uint32 grass = ((h >> 8) & 3) == 0 ? COLOR_GRASS_DARK : COLOR_GRASS;
+    const int laneWidth = mWidth / LANES;
+
+    for (int row = 0; row < mStripHeight; ++row) {
+        // Distance along the road of this row; rows go up the screen as
+        // distance increases, and row 0 is the strip's top (furthest) row
+        long long d = index * mStripHeight + (mStripHeight - 1 - row);
+        bool curbRed = (d / (CURB_PERIOD / 2)) % 2 == 0;
+        bool dash = d % DASH_PERIOD < DASH_LENGTH;
+        Uint32* out = pixels + static_cast<std::size_t>(row) * mWidth;
+
+        for (int x = 0; x < mWidth; ++x) {
+            int fromEdge = x < mWidth - 1 - x ? x : mWidth - 1 - x;
+            Uint32 c = COLOR_ASPHALT;
+            if (fromEdge < SHOULDER_WIDTH - CURB_WIDTH) {
+                c = grass;
+            } else if (fromEdge < SHOULDER_WIDTH) {
+                c = curbRed ? COLOR_CURB_RED : COLOR_CURB_WHITE;
+            } else if (dash) {
+                for (int lane = 1; lane < LANES; ++lane) {
+                    int lineX = lane * laneWidth - LINE_WIDTH / 2;
+                    if (x >= lineX && x < lineX + LINE_WIDTH) {
+                        c = COLOR_LINE;
+                    }
+                }
+            }
+            // A little per-pixel grain so the asphalt does not look flat
+            if (c == COLOR_ASPHALT && ((hashStrip(h, d * mWidth + x) & 15) == 0)) {
+                c = 0xFF4A4A4A;
+            }
+            out[x] = c;
+        }
+    }
+}
+
+void RoadStreamer::render(double distance) {
+    if (mSlots.empty()) {
+        return;
+    }
+    const long long ring = static_cast<long long>(mSlots.size());
+    long long first = static_cast<long long>(distance) / mStripHeight;
+    long long last = static_cast<long long>(distance + mScreenHeight) / mStripHeight;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (first != mFirstNeeded) {
+        mFirstNeeded = first;
+        mWake.notify_one();
+    }
+
+    // Upload every finished strip in the ring, visible or not, so a strip
+    // scrolling into view never waits on its upload
+    for (Slot& slot : mSlots) {
+        if (slot.state == SLOT_READY && slot.index >= first) {
+            SDL_UpdateTexture(slot.texture, nullptr, slot.pixels.data(), mWidth * static_cast<int>(sizeof(Uint32)));
+            slot.state = SLOT_UPLOADED;
+        }
+    }
+
+    // Misses are filled in grey; the caller's draw colour is put back after
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(mRenderer, &r, &g, &b, &a);
+    for (long long k = first; k <= last; ++k) {
+        const Slot& slot = mSlots[k % ring];
+        // Screen y of the strip's top row
+        int y = mScreenHeight - static_cast<int>((k + 1) * mStripHeight - static_cast<long long>(distance));
+        SDL_Rect dst = { 0, y, mWidth, mStripHeight };
+        if (slot.index == k && slot.state == SLOT_UPLOADED) {
+            SDL_RenderCopy(mRenderer, slot.texture, nullptr, &dst);
+        } else {
+            ++mMisses;
+            SDL_SetRenderDrawColor(mRenderer, 0x42, 0x42, 0x42, 0xFF);
+            SDL_RenderFillRect(mRenderer, &dst);
+        }
+    }
+    SDL_SetRenderDrawColor(mRenderer, r, g, b, a);
+}
+
+int RoadStreamer::getMisses() const {
+    return mMisses;
+}
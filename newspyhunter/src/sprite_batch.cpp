@@ -0,0 +1,124 @@
+#include "sprite_batch.h"
+#include <algorithm>
+
+SpriteBatch::SpriteBatch()
+    : mRenderer(nullptr), mArena(nullptr), mMaxSprites(0), mLayer(0), mOrder(0),
+      mDrawCalls(0), mSpriteCount(0), mLastDrawCalls(0), mLastSpriteCount(0) {}
+
+void SpriteBatch::setRenderer(SDL_Renderer* renderer) {
+    mRenderer = renderer;
+}
+
+void SpriteBatch::setArena(FrameArena* arena, std::size_t maxSprites) {
+    mArena = arena;
+    mMaxSprites = maxSprites;
+    mSprites = FrameList<Sprite>();
+}
+
+void SpriteBatch::setLayer(int layer) {
+    mLayer = layer;
+}
+
+void SpriteBatch::add(SDL_Texture* texture, int texW, int texH, const SDL_Rect* src, const SDL_Rect& dst) {
+    if (!texture || texW <= 0 || texH <= 0) {
+        return;
+    }
+    Sprite sprite;
+    sprite.layer = mLayer;
+    sprite.texture = texture;
+    sprite.order = mOrder++;
+    if (src) {
+        sprite.uv = { static_cast<float>(src->x) / texW, static_cast<float>(src->y) / texH,
+                      static_cast<float>(src->w) / texW, static_cast<float>(src->h) / texH };
+    } else {
+        sprite.uv = { 0.0f, 0.0f, 1.0f, 1.0f };
+    }
+    sprite.dst = dst;
+
+    // First sprite since the last flush takes a fresh list from the arena
+    if (mSprites.capacity() == 0 && mArena) {
+        mSprites = FrameList<Sprite>(*mArena, mMaxSprites);
+    }
+    if (mSprites.full() && !mSprites.empty()) {
+        drawQueued();
+    }
+    if (!mSprites.push_back(sprite)) {
+        SDL_RenderCopy(mRenderer, texture, src, &dst);
+        ++mDrawCalls;
+        ++mSpriteCount;
+    }
+}
+
+void SpriteBatch::flush() {
+    drawQueued();
+    // The list is given back; the arena may be reset before the next frame
+    mSprites = FrameList<Sprite>();
+    mOrder = 0;
+    mLastDrawCalls = mDrawCalls;
+    mLastSpriteCount = mSpriteCount;
+    mDrawCalls = 0;
+    mSpriteCount = 0;
+}
+
+void SpriteBatch::drawQueued() {
+    mSpriteCount += mSprites.size();
+    if (mSprites.empty() || !mRenderer) {
+        mSprites.clear();
+        return;
+    }
+
+    // Submission order is part of the key, so std::sort gives a stable
+    // result without stable_sort's temporary buffer.
+    std::sort(mSprites.begin(), mSprites.end(), [](const Sprite& a, const Sprite& b) {
+        if (a.layer != b.layer) return a.layer < b.layer;
+        if (a.texture != b.texture) return a.texture < b.texture;
+        return a.order < b.order;
+    });
+
+    const SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+    std::size_t runStart = 0;
+    while (runStart < mSprites.size()) {
+        std::size_t runEnd = runStart;
+        mVertices.clear();
+        mIndices.clear();
+        while (runEnd < mSprites.size() && mSprites[runEnd].texture == mSprites[runStart].texture
+               && mSprites[runEnd].layer == mSprites[runStart].layer) {
+            const Sprite& s = mSprites[runEnd];
+            float x0 = static_cast<float>(s.dst.x);
+            float y0 = static_cast<float>(s.dst.y);
+            float x1 = static_cast<float>(s.dst.x + s.dst.w);
+            float y1 = static_cast<float>(s.dst.y + s.dst.h);
+            float u0 = s.uv.x;
+            float v0 = s.uv.y;
+            float u1 = s.uv.x + s.uv.w;
+            float v1 = s.uv.y + s.uv.h;
+
+            int base = static_cast<int>(mVertices.size());
+            mVertices.push_back({ { x0, y0 }, white, { u0, v0 } });
+            mVertices.push_back({ { x1, y0 }, white, { u1, v0 } });
+            mVertices.push_back({ { x1, y1 }, white, { u1, v1 } });
+            mVertices.push_back({ { x0, y1 }, white, { u0, v1 } });
+            mIndices.push_back(base);
+            mIndices.push_back(base + 1);
+            mIndices.push_back(base + 2);
+            mIndices.push_back(base);
+            mIndices.push_back(base + 2);
+            mIndices.push_back(base + 3);
+            ++runEnd;
+        }
+
+        SDL_RenderGeometry(mRenderer, mSprites[runStart].texture, mVertices.data(), static_cast<int>(mVertices.size()),
+                           mIndices.data(), static_cast<int>(mIndices.size()));
+        ++mDrawCalls;
+        runStart = runEnd;
+    }
+    mSprites.clear();
+}
+
+int SpriteBatch::getLastDrawCalls() const {
+    return mLastDrawCalls;
+}
+
+std::size_t SpriteBatch::getLastSpriteCount() const {
+    return mLastSpriteCount;
+}
@@ -1,5 +1,7 @@
 #include <SDL2/SDL.h>
+#include <cstdint>
 #include <vector>
+#include "../../common/aabb_batch.h"
 
 // Structure for platforms
 struct Platform {
@@ -24,6 +26,41 @@ struct Collectible {
     bool isCollected;
 };
 
+// The rects of a list of things in structure-of-arrays form, so the player
+// can be tested against all of them in one aabb::overlapOneVsMany call.
+// Overlap has strict edges, like SDL_HasIntersection.
+struct BoxList {
+    std::vector<std::int32_t> x;
+    std::vector<std::int32_t> y;
+    std::vector<std::int32_t> w;
+    std::vector<std::int32_t> h;
+    std::vector<std::uint64_t> mask;
+
+    // Copies every item's rect and tests rect against them; returns the
+    // number of hits
+    template <typename T>
+    std::size_t overlap(const SDL_Rect& rect, const std::vector<T>& items) {
+        x.resize(items.size());
+        y.resize(items.size());
+        w.resize(items.size());
+        h.resize(items.size());
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            x[i] = items[i].rect.x;
+            y[i] = items[i].rect.y;
+            w[i] = items[i].rect.w;
+            h[i] = items[i].rect.h;
+        }
+        aabb::BoxesSoA boxes = { x.data(), y.data(), w.data(), h.data(), items.size() };
+        mask.resize(aabb::maskWords(boxes.count));
+        return aabb::overlapOneVsMany(rect.x, rect.y, rect.w, rect.h, boxes, mask.data());
+    }
+
+    // Whether item i was hit by the last overlap()
+    bool hit(std::size_t i) const {
+        return aabb::testBit(mask.data(), i);
+    }
+};
+
 int main(int argc, char* argv[]) {
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -82,6 +119,11 @@ int main(int argc, char* argv[]) {
     Collectible collectible1 = { { 600, 250, 30, 30 }, false }; // Using rect for simplicity
     collectibles.push_back(collectible1);
 
+    // Player against each list, reused every frame
+    BoxList platformBoxes;
+    BoxList enemyBoxes;
+    BoxList collectibleBoxes;
+
     // Score
     int score = 0;
     // (SDL_ttf would be needed for text rendering, omitted for simplicity)
@@ -120,10 +162,13 @@ int main(int argc, char* argv[]) {
             isJumping = false;
         }
 
-        // Collision with platforms
-        for (auto& platform : platforms) {
-            if (SDL_HasIntersection(&playerRect, &platform.rect)) {
-                if (playerVelocityY > 0 && playerRect.y < platform.rect.y) {
+        // Collision with platforms. Once one lands the player, velocity is
+        // 0 and no later platform acts, so testing every platform against
+        // the position before landing is the same as testing one by one.
+        if (platformBoxes.overlap(playerRect, platforms) > 0) {
+            for (std::size_t i = 0; i < platforms.size(); ++i) {
+                const Platform& platform = platforms[i];
+                if (platformBoxes.hit(i) && playerVelocityY > 0 && playerRect.y < platform.rect.y) {
                     playerRect.y = platform.rect.y - playerRect.h;
                     playerVelocityY = 0;
                     isJumping = false;
@@ -155,20 +200,21 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        // Collision with enemies
-        for (auto& enemy : enemies) {
-            if (SDL_HasIntersection(&playerRect, &enemy.rect)) {
-                playerRect.x = 100;
-                playerRect.y = 500;
-                playerVelocityY = 0;
-            }
+        // Collision with enemies: touching any one sends the player back
+        // to the start
+        if (enemyBoxes.overlap(playerRect, enemies) > 0) {
+            playerRect.x = 100;
+            playerRect.y = 500;
+            playerVelocityY = 0;
         }
 
         // Collect collectibles
-        for (auto& collectible : collectibles) {
-            if (!collectible.isCollected && SDL_HasIntersection(&playerRect, &collectible.rect)) {
-                collectible.isCollected = true;
-                score += 10;
+        if (collectibleBoxes.overlap(playerRect, collectibles) > 0) {
+            for (std::size_t i = 0; i < collectibles.size(); ++i) {
+                if (!collectibles[i].isCollected && collectibleBoxes.hit(i)) {
+                    collectibles[i].isCollected = true;
+                    score += 10;
+                }
             }
         }
 
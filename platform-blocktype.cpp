@@ -1,8 +1,11 @@
 #include <SDL.h>
 #include <SDL_image.h>
+#include <algorithm>
+#include <array>
 #include <iostream>
-#include <fstream>
 #include <vector>
+#include "common/dirty_present.h"
+#include "common/tile_grid.h"
 
 const int SCREEN_WIDTH = 800;
 const int SCREEN_HEIGHT = 600;
@@ -10,29 +13,80 @@ const int BLOCK_SIZE = 32;
 const float GRAVITY = 0.5f;
 const float JUMP_STRENGTH = -10.0f;
 
+const float MOVE_SPEED = 3.0f;
+const float CLIMB_SPEED = 2.0f;
+const float SPAWN_X = 100;
+const float SPAWN_Y = 100;
+const int PLAYER_SIZE = 32;
+// Most tiles a player's side can overlap
+const int PLAYER_SPAN = (PLAYER_SIZE - 1) / BLOCK_SIZE + 2;
+
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
 
+// What a tile type does, as bits of TileType::flags
+enum TileFlag : Uint8 {
+    TILE_SOLID = 1 << 0,    // blocks from every side
+    TILE_ONE_WAY = 1 << 1,  // blocks only when landed on from above
+    TILE_DEADLY = 1 << 2,   // touching it sends the player back to the start
+    TILE_LADDER = 1 << 3,   // no gravity inside; up and down climb
+};
+
+struct TileType {
+    Uint8 flags;
+    float friction; // share of the gap to the walking speed closed each frame on it
+    Uint8 red, green, blue;
+};
+
+// Indexed by the tile value in the map, so one lookup gives everything a
+// tile does and a new block type is one more entry. Values without an
+// entry are empty.
+std::array<TileType, 256> makeTileTypes() {
+    std::array<TileType, 256> types{};
+    types[1] = { TILE_SOLID, 1.0f, 0, 0, 255 };                  // block
+    types[2] = { TILE_SOLID, 0.05f, 150, 220, 255 };             // ice, slippery
+    types[3] = { TILE_SOLID | TILE_DEADLY, 1.0f, 255, 140, 0 };  // lava
+    types[4] = { TILE_ONE_WAY, 1.0f, 120, 80, 40 };              // platform you can jump up through
+    types[5] = { TILE_LADDER, 1.0f, 200, 170, 90 };              // ladder
+    return types;
+}
+
+const std::array<TileType, 256> TILE_TYPES = makeTileTypes();
+
 struct Player {
     float x, y;
     float velX, velY;
     bool onGround;
+    bool onLadder;
     int width, height;
+    int moveX, climbY; // input direction, -1, 0 or 1
+    float friction;    // of the tile last stood on; kept in the air so a jump off ice still slides
 
-    Player() : x(100), y(100), velX(0), velY(0), onGround(false), width(32), height(32) {}
+    Player() : x(SPAWN_X), y(SPAWN_Y), velX(0), velY(0), onGround(false), onLadder(false), width(PLAYER_SIZE), height(PLAYER_SIZE),
+               moveX(0), climbY(0), friction(1.0f) {}
 
-    void update(std::vector<std::vector<int>>& map) {
-        // Apply gravity
-        if (!onGround) {
+    void update(const TileGrid& map) {
+        // Close in on the walking speed as fast as the ground allows
+        velX += (moveX * MOVE_SPEED - velX) * friction;
+
+        // Apply gravity, or climb
+        if (onLadder) {
+            velY = climbY * CLIMB_SPEED;
+        } else if (!onGround) {
             velY += GRAVITY;
         }
 
         // Update position
+        float oldBottom = y + height;
         x += velX;
         y += velY;
 
-        // Collision detection
+        // Collision detection. Each touched tile is one table lookup; its
+        // flags are kept for the horizontal pass and gathered for the
+        // checks afterwards.
         onGround = false;
+        Uint8 touched = 0;
+        std::array<Uint8, PLAYER_SPAN * PLAYER_SPAN> flags;
         int leftTile = x / BLOCK_SIZE;
         int rightTile = (x + width - 1) / BLOCK_SIZE;
         int topTile = y / BLOCK_SIZE;
@@ -40,15 +94,25 @@ struct Player {
 
         for (int i = topTile; i <= bottomTile; ++i) {
             for (int j = leftTile; j <= rightTile; ++j) {
-                if (i >= 0 && i < map.size() && j >= 0 && j < map[i].size() && map[i][j] == 1) {
-                    if (velY > 0 && y + height > i * BLOCK_SIZE) {
+                const TileType& type = TILE_TYPES[map.get(j, i)];
+                flags[(i - topTile) * PLAYER_SPAN + j - leftTile] = type.flags;
+                touched |= type.flags;
+                bool landing = velY > 0 && y + height > i * BLOCK_SIZE;
+                if (type.flags & TILE_SOLID) {
+                    if (landing) {
                         y = i * BLOCK_SIZE - height;
                         velY = 0;
                         onGround = true;
+                        friction = type.friction;
                     } else if (velY < 0 && y < (i + 1) * BLOCK_SIZE) {
                         y = (i + 1) * BLOCK_SIZE;
                         velY = 0;
                     }
+                } else if ((type.flags & TILE_ONE_WAY) && landing && oldBottom <= i * BLOCK_SIZE) {
+                    y = i * BLOCK_SIZE - height;
+                    velY = 0;
+                    onGround = true;
+                    friction = type.friction;
                 }
             }
         }
@@ -56,7 +120,7 @@ struct Player {
         // Horizontal collision
         for (int i = topTile; i <= bottomTile; ++i) {
             for (int j = leftTile; j <= rightTile; ++j) {
-                if (i >= 0 && i < map.size() && j >= 0 && j < map[i].size() && map[i][j] == 1) {
+                if (flags[(i - topTile) * PLAYER_SPAN + j - leftTile] & TILE_SOLID) {
                     if (velX > 0 && x + width > j * BLOCK_SIZE) {
                         x = j * BLOCK_SIZE - width;
                         velX = 0;
@@ -67,232 +131,54 @@ struct Player {
                 }
             }
         }
+
+        // Ladders are grabbed with up or down, and kept until left or jumped off
+        onLadder = (touched & TILE_LADDER) && (onLadder || climbY != 0);
+        if (touched & TILE_DEADLY) {
+            x = SPAWN_X;
+            y = SPAWN_Y;
+            velX = 0;
+            velY = 0;
+        }
     }
 
-    void render() {
+    // Where render() draws
+    DirtyRect bounds() const {
+        return { static_cast<int>(x), static_cast<int>(y), width, height };
+    }
+
+    void render() const {
         SDL_Rect rect = { static_cast<int>(x), static_cast<int>(y), width, height };
         SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
         SDL_RenderFillRect(renderer, &rect);
     }
 };
 
-std::vector<std::vector<int>> loadMap(const std::string& filename) {
-    std::ifstream file(filename);
-    std::vector<std::vector<int>> map;
-    std::string line;
-
-    while (std::getline(file, line)) {
-        std::vector<int> row;
-        for (char ch : line) {
-            if (ch == '0' || ch == '1') {
-                row.push_back(ch - '0');
-            }
-        }
-        map.push_back(row);
-    }
-
-    return map;
-}
-
-void renderMap(const std::vector<std::vector<int>>& map) {
-    for (int i = 0; i < map.size(); ++i) {
-        for (int j = 0; j < map[i].size(); ++j) {
-            if (map[i][j] == 1) {
+// Draws the tiles that overlap area
+void renderMap(const TileGrid& map, const SDL_Rect& area) {
+    int firstRow = std::max(area.y / BLOCK_SIZE, 0);
+    int lastRow = std::min((area.y + area.h - 1) / BLOCK_SIZE, map.height() - 1);
+    int firstColumn = std::max(area.x / BLOCK_SIZE, 0);
+    int lastColumn = std::min((area.x + area.w - 1) / BLOCK_SIZE, map.width() - 1);
+    for (int i = firstRow; i <= lastRow; ++i) {
+        auto row = map.row(i);
+        for (int j = firstColumn; j <= lastColumn; ++j) {
+            const TileType& type = TILE_TYPES[row[j]];
+            if (type.flags != 0) {
                 SDL_Rect rect = { j * BLOCK_SIZE, i * BLOCK_SIZE, BLOCK_SIZE, BLOCK_SIZE };
-                SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
+                SDL_SetRenderDrawColor(renderer, type.red, type.green, type.blue, 255);
                 SDL_RenderFillRect(renderer, &rect);
             }
         }
     }
 }
 
-int main(int argc, char* argv[]) {
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
-        return 1;
-    }
-
-    window = SDL_CreateWindow("Platformer", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-    if (window == nullptr) {
-        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        return 1;
-    }
-
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    if (renderer == nullptr) {
-        std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        return 1;
-    }
-
-    std::vector<std::vector<int>> map = loadMap("map.txt");
-    Player player;
-
-    bool running = true;
-    SDL_Event e;
-
-    while (running) {
-        while (SDL_PollEvent(&e) != 0) {
-            if (e.type == SDL_QUIT) {
-                running = false;
-            } else if (e.type == SDL_KEYDOWN) {
-                switch (e.key.keysym.sym) {
-                    case SDLK_SPACE:
-                        if (player.onGround) {
-                            player.velY = JUMP_STRENGTH;
-                            player.onGround = false;
-                        }
-                        break;
-                    case SDLK_LEFT:
-                        player.velX = -3;
-                        break;
-                    case SDLK_RIGHT:
-                        player.velX = 3;
-                        break;
-                }
-            } else if (e.type == SDL_KEYUP) {
-                switch (e.key.keysym.sym) {
-                    case SDLK_LEFT:
-                    case SDLK_RIGHT:
-                        player.velX = 0;
-                        break;
-                }
-            }
-        }
-
-        player.update(map);
-
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        SDL_RenderClear(renderer);
-
-        renderMap(map);
-        player.render();
-
-        SDL_RenderPresent(renderer);
-        SDL_Delay(16); // ~60 FPS
-    }
-
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
-
-    return 0;
-}
-/*
-### Adding More Block Types:
-If you want to add more block types (e.g., blocks with different behaviors), you can extend the `map.txt` format and modify the collision logic. For example:
-- Use `2` for slippery blocks.
-- Use `3` for deadly blocks.
-
-Then, update the `Player::update` function to handle these new block types.
-*/
-with #include <SDL.h>
-#include <iostream>
-#include <fstream>
-#include <vector>
-
-const int SCREEN_WIDTH = 800;
-const int SCREEN_HEIGHT = 600;
-const int BLOCK_SIZE = 32;
-const float GRAVITY = 0.5f;
-const float JUMP_STRENGTH = -10.0f;
-
-SDL_Window* window = nullptr;
-SDL_Renderer* renderer = nullptr;
-
-struct Player {
-    float x, y;
-    float velX, velY;
-    bool onGround;
-    int width, height;
-
-    Player() : x(100), y(100), velX(0), velY(0), onGround(false), width(32), height(32) {}
-
-    void update(std::vector<std::vector<int>>& map);
-    void render();
-};
-
-void Player::update(std::vector<std::vector<int>>& map) {
-    // Apply gravity
-    if (!onGround) {
-        velY += GRAVITY;
-    }
-
-    // Update position
-    x += velX;
-    y += velY;
-
-    // Collision detection
-    onGround = false;
-    int leftTile = x / BLOCK_SIZE;
-    int rightTile = (x + width - 1) / BLOCK_SIZE;
-    int topTile = y / BLOCK_SIZE;
-    int bottomTile = (y + height - 1) / BLOCK_SIZE;
-
-    for (int i = topTile; i <= bottomTile; ++i) {
-        for (int j = leftTile; j <= rightTile; ++j) {
-            if (i >= 0 && i < map.size() && j >= 0 && j < map[i].size() && map[i][j] == 1) {
-                if (velY > 0 && y + height > i * BLOCK_SIZE) {
-                    y = i * BLOCK_SIZE - height;
-                    velY = 0;
-                    onGround = true;
-                } else if (velY < 0 && y < (i + 1) * BLOCK_SIZE) {
-                    y = (i + 1) * BLOCK_SIZE;
-                    velY = 0;
-                }
-            }
-        }
-    }
-
-    // Horizontal collision
-    for (int i = topTile; i <= bottomTile; ++i) {
-        for (int j = leftTile; j <= rightTile; ++j) {
-            if (i >= 0 && i < map.size() && j >= 0 && j < map[i].size() && map[i][j] == 1) {
-                if (velX > 0 && x + width > j * BLOCK_SIZE) {
-                    x = j * BLOCK_SIZE - width;
-                    velX = 0;
-                } else if (velX < 0 && x < (j + 1) * BLOCK_SIZE) {
-                    x = (j + 1) * BLOCK_SIZE;
-                    velX = 0;
-                }
-            }
-        }
-    }
-}
-
-void Player::render() {
-    SDL_Rect rect = { static_cast<int>(x), static_cast<int>(y), width, height };
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-    SDL_RenderFillRect(renderer, &rect);
-}
-
-std::vector<std::vector<int>> loadMap(const std::string& filename) {
-    std::ifstream file(filename);
-    std::vector<std::vector<int>> map;
-    std::string line;
-
-    while (std::getline(file, line)) {
-        std::vector<int> row;
-        for (char ch : line) {
-            if (ch == '0' || ch == '1') {
-                row.push_back(ch - '0');
-            }
-        }
-        map.push_back(row);
-    }
-
-    return map;
-}
-
-void renderMap(const std::vector<std::vector<int>>& map) {
-    for (int i = 0; i < map.size(); ++i) {
-        for (int j = 0; j < map[i].size(); ++j) {
-            if (map[i][j] == 1) {
-                SDL_Rect rect = { j * BLOCK_SIZE, i * BLOCK_SIZE, BLOCK_SIZE, BLOCK_SIZE };
-                SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
-                SDL_RenderFillRect(renderer, &rect);
-            }
-        }
-    }
+// Redraws everything inside area
+void renderScene(const TileGrid& map, const Player& player, const SDL_Rect& area) {
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderFillRect(renderer, &area);
+    renderMap(map, area);
+    player.render();
 }
 
 int main(int argc, char* argv[]) {
@@ -313,60 +199,82 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    std::vector<std::vector<int>> map = loadMap("map.txt");
+    TileGrid map;
+    loadDigitGrid("map.txt", map);
     Player player;
 
+    // The frame is kept in a texture; only what changed is redrawn, and a
+    // frame where nothing changed is not presented at all
+    DirtyPresenter presenter(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+    DirtyRects& dirty = presenter.dirty();
+
     bool running = true;
     SDL_Event e;
 
     while (running) {
         while (SDL_PollEvent(&e) != 0) {
+            presenter.handleEvent(e);
             if (e.type == SDL_QUIT) {
                 running = false;
             } else if (e.type == SDL_KEYDOWN) {
                 switch (e.key.keysym.sym) {
                     case SDLK_SPACE:
-                        if (player.onGround) {
+                        if (player.onGround || player.onLadder) {
                             player.velY = JUMP_STRENGTH;
                             player.onGround = false;
+                            player.onLadder = false;
                         }
                         break;
                     case SDLK_LEFT:
-                        player.velX = -3;
+                        player.moveX = -1;
                         break;
                     case SDLK_RIGHT:
-                        player.velX = 3;
+                        player.moveX = 1;
+                        break;
+                    case SDLK_UP:
+                        player.climbY = -1;
+                        break;
+                    case SDLK_DOWN:
+                        player.climbY = 1;
                         break;
                 }
             } else if (e.type == SDL_KEYUP) {
                 switch (e.key.keysym.sym) {
                     case SDLK_LEFT:
                     case SDLK_RIGHT:
-                        player.velX = 0;
+                        player.moveX = 0;
+                        break;
+                    case SDLK_UP:
+                    case SDLK_DOWN:
+                        player.climbY = 0;
                         break;
                 }
             }
         }
 
+        DirtyRect before = player.bounds();
         player.update(map);
+        dirty.move(before, player.bounds());
 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        SDL_RenderClear(renderer);
-
-        renderMap(map);
-        player.render();
-
-        SDL_RenderPresent(renderer);
+        presenter.present([&](const SDL_Rect& area) { renderScene(map, player, area); });
         SDL_Delay(16); // ~60 FPS
     }
 
+    presenter.close();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
 
     return 0;
 }
-
-
-
-
+/*
+### Block Types:
+`map.txt` tiles index `TILE_TYPES`:
+- `1` solid block
+- `2` ice: solid and slippery
+- `3` lava: solid and deadly
+- `4` one-way platform, solid only from above
+- `5` ladder: up and down climb, space jumps off
+
+To add a block type, give it an entry in `makeTileTypes()`. `Player::update` only looks at the flags, so it needs no change.
+*/
@@ -0,0 +1,91 @@
+#ifndef CHUNK_CACHE_H
+#define CHUNK_CACHE_H
+
+#include <SDL2/SDL.h>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "../../common/tile_grid.h"
+
+class RegionPager;
+
+// Pre-baked tile chunks for drawing the map.
+//
+// The map is cut into CHUNK_TILES x CHUNK_TILES squares. The first time a
+// chunk is on screen its solid tiles are drawn once into a render-target
+// texture; after that the chunk is one SDL_RenderCopy, so a screen takes a
+// handful of copies however dense the tiles are. markDirty() re-bakes a
+// chunk the next time it is drawn. At most maxChunks are kept; past that
+// the least recently drawn one is evicted and its texture reused.
+// setTint() shades the blocks, e.g. for a parallax layer further back.
+class ChunkCache {
+public:
+    static const int CHUNK_TILES = 16;
+    // Fills tiles, CHUNK_TILES a side, with the chunk whose top-left tile
+    // is (firstX, firstY)
+    typedef std::function<void(int firstX, int firstY, TileGrid& tiles)> ChunkSource;
+
+    ChunkCache(SDL_Renderer* renderer, SDL_Texture* blockTexture, int tileSize, int maxChunks);
+    ~ChunkCache();
+
+    // Draws the part of the map inside the camera rectangle
+    void render(const TileGrid& map, int cameraX, int cameraY, int width, int height);
+    // The same for a streamed level. Chunks whose region is still loading
+    // are skipped and baked once it arrives. The region size must be a
+    // multiple of CHUNK_TILES.
+    void render(const RegionPager& pager, int cameraX, int cameraY, int width, int height);
+    // The same for tiles made up chunk by chunk, e.g. generated scenery;
+    // the map has no edge right or below
+    void render(const ChunkSource& source, int cameraX, int cameraY, int width, int height);
+
+    // The tile at (tileX, tileY) changed
+    void markDirty(int tileX, int tileY);
+    // Every chunk needs baking again, e.g. after SDL_RENDER_TARGETS_RESET
+    void markAllDirty();
+    // Destroys every chunk texture; call before the renderer goes
+    void clear();
+    // Colour the blocks are multiplied by, and the alpha chunks are drawn
+    // with. Re-bakes everything; meant to be set once.
+    void setTint(Uint8 red, Uint8 green, Uint8 blue, Uint8 alpha);
+
+    int getBakes() const;
+    int getEvictions() const;
+    int getCopies() const; // copies made by the last render()
+    int getResident() const;
+
+private:
+    struct Chunk {
+        long long key;
+        SDL_Texture* texture;
+        bool dirty;
+        bool solid; // false for chunks with no solid tiles, which keep no texture
+    };
+
+    SDL_Renderer* mRenderer;
+    SDL_Texture* mBlockTexture;
+    int mTileSize;
+    int mMaxChunks;
+    // Most recently drawn at the front
+    std::list<Chunk> mChunks;
+    std::unordered_map<long long, std::list<Chunk>::iterator> mLookup;
+    std::vector<SDL_Texture*> mFreeTextures;
+    int mBakes;
+    int mEvictions;
+    int mCopies;
+    SDL_Color mTint;
+    // The chunk render(ChunkSource) is drawing
+    TileGrid mSourceTiles;
+
+    static long long makeKey(int chunkX, int chunkY);
+    Chunk& fetch(int chunkX, int chunkY);
+    // Chunks read their tiles from a view holding them, starting at
+    // (firstX, firstY): the whole map, or the region the chunk is in
+    template <typename Lookup>
+    void renderChunks(int cameraX, int cameraY, int width, int height, Lookup lookup);
+    void drawTiles(const TileGridView& tiles, int firstX, int firstY, int originX, int originY, Uint8 alpha);
+    void bake(Chunk& chunk, const TileGridView& tiles, int firstX, int firstY);
+    void evictOldest();
+};
+
+#endif // CHUNK_CACHE_H
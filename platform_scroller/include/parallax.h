@@ -0,0 +1,66 @@
+#ifndef PARALLAX_H
+#define PARALLAX_H
+
+#include <SDL2/SDL.h>
+#include <memory>
+#include <vector>
+#include "../../common/tile_grid.h"
+#include "chunk_cache.h"
+
+// Tile layers that scroll at their own speed behind or in front of the
+// playfield.
+//
+// A layer with scroll factor s is drawn as if the camera stood at
+// (cameraX * s, cameraY * s): below 1 it drifts past slower and reads as
+// further away, above 1 faster and nearer. Each layer has its own
+// ChunkCache, so it is culled to the chunks its shifted camera can see and
+// costs one copy per visible chunk that has any blocks. Layers never
+// change once added; their chunks are baked once and only again after a
+// render target reset.
+class Parallax {
+public:
+    Parallax(SDL_Renderer* renderer, SDL_Texture* blockTexture, int tileSize);
+
+    // Adds a layer. Layers are drawn in the order they were added; front
+    // ones by renderFront(), after the player, the rest by renderBack().
+    void addLayer(TileGrid tiles, float scroll, bool front, SDL_Color tint);
+    // A layer whose tiles source makes up as they come into view, so it
+    // takes no memory and goes on forever
+    void addLayer(ChunkCache::ChunkSource source, float scroll, bool front, SDL_Color tint);
+
+    // Draws the back or front layers for a playfield camera at (cameraX, cameraY)
+    void renderBack(int cameraX, int cameraY, int width, int height);
+    void renderFront(int cameraX, int cameraY, int width, int height);
+
+    // Every chunk needs baking again, e.g. after SDL_RENDER_TARGETS_RESET
+    void markAllDirty();
+    // Destroys every chunk texture; call before the renderer goes
+    void clear();
+
+    int getLayerCount() const;
+    int getCopies() const; // copies made by the last renderBack() and renderFront()
+
+    // Layer width or height, in tiles, that a camera scrolling over
+    // mapTiles playfield tiles with a view of viewPixels needs at scroll
+    static int layerTiles(int mapTiles, int viewPixels, float scroll, int tileSize);
+
+private:
+    struct Layer {
+        TileGrid tiles;
+        ChunkCache::ChunkSource source; // used instead of tiles if set
+        float scroll;
+        bool front;
+        std::unique_ptr<ChunkCache> chunks;
+    };
+
+    SDL_Renderer* mRenderer;
+    SDL_Texture* mBlockTexture;
+    int mTileSize;
+    std::vector<Layer> mLayers;
+    int mBackCopies;
+    int mFrontCopies;
+
+    int renderLayers(bool front, int cameraX, int cameraY, int width, int height);
+};
+
+#endif // PARALLAX_H
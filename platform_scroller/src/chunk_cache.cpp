@@ -0,0 +1,248 @@
+#include "chunk_cache.h"
+#include <algorithm>
+#include <iostream>
+#include "../../common/region_pager.h"
+
+static_assert(REGION_ALIGN % ChunkCache::CHUNK_TILES == 0, "region sides must be whole chunks");
+
+ChunkCache::ChunkCache(SDL_Renderer* renderer, SDL_Texture* blockTexture, int tileSize, int maxChunks)
+    : mRenderer(renderer), mBlockTexture(blockTexture), mTileSize(tileSize), mMaxChunks(maxChunks),
+      mBakes(0), mEvictions(0), mCopies(0), mTint({ 255, 255, 255, 255 }),
+      mSourceTiles(CHUNK_TILES, CHUNK_TILES) {
+    // Keep room for a whole screen of chunks so render() never evicts one
+    // it is still drawing
+    if (mMaxChunks < 16) {
+        mMaxChunks = 16;
+    }
+}
+
+ChunkCache::~ChunkCache() {
+    clear();
+}
+
+void ChunkCache::clear() {
+    for (Chunk& chunk : mChunks) {
+        if (chunk.texture) {
+            SDL_DestroyTexture(chunk.texture);
+        }
+    }
+    for (SDL_Texture* texture : mFreeTextures) {
+        SDL_DestroyTexture(texture);
+    }
+    mChunks.clear();
+    mLookup.clear();
+    mFreeTextures.clear();
+}
+
+long long ChunkCache::makeKey(int chunkX, int chunkY) {
+    return (static_cast<long long>(chunkY) << 32) | static_cast<unsigned int>(chunkX);
+}
+
+ChunkCache::Chunk& ChunkCache::fetch(int chunkX, int chunkY) {
+    long long key = makeKey(chunkX, chunkY);
+    auto found = mLookup.find(key);
+    if (found != mLookup.end()) {
+        mChunks.splice(mChunks.begin(), mChunks, found->second);
+        return mChunks.front();
+    }
+    mChunks.push_front({ key, nullptr, true, true });
+    mLookup[key] = mChunks.begin();
+    if (static_cast<int>(mChunks.size()) > mMaxChunks) {
+        evictOldest();
+    }
+    return mChunks.front();
+}
+
+void ChunkCache::evictOldest() {
+    Chunk& oldest = mChunks.back();
+    if (oldest.texture) {
+        mFreeTextures.push_back(oldest.texture);
+    }
+    mLookup.erase(oldest.key);
+    mChunks.pop_back();
+    ++mEvictions;
+}
+
+// Draws the chunk's solid tiles with its top-left corner at (originX, originY)
+void ChunkCache::drawTiles(const TileGridView& tiles, int firstX, int firstY, int originX, int originY, Uint8 alpha) {
+    SDL_SetTextureColorMod(mBlockTexture, mTint.r, mTint.g, mTint.b);
+    SDL_SetTextureAlphaMod(mBlockTexture, alpha);
+    int lastX = std::min(firstX + CHUNK_TILES, tiles.width());
+    int lastY = std::min(firstY + CHUNK_TILES, tiles.height());
+    for (int y = firstY; y < lastY; ++y) {
+        auto row = tiles.row(y);
+        for (int x = firstX; x < lastX; ++x) {
+            if (row[x] == 1) {
+                SDL_Rect dstRect = { originX + (x - firstX) * mTileSize, originY + (y - firstY) * mTileSize, mTileSize, mTileSize };
+                SDL_RenderCopy(mRenderer, mBlockTexture, nullptr, &dstRect);
+            }
+        }
+    }
+    // The block texture is shared with other layers
+    SDL_SetTextureColorMod(mBlockTexture, 255, 255, 255);
+    SDL_SetTextureAlphaMod(mBlockTexture, 255);
+}
+
+void ChunkCache::bake(Chunk& chunk, const TileGridView& tiles, int firstX, int firstY) {
+    chunk.dirty = false;
+    chunk.solid = false;
+    int lastX = std::min(firstX + CHUNK_TILES, tiles.width());
+    int lastY = std::min(firstY + CHUNK_TILES, tiles.height());
+    for (int y = firstY; y < lastY && !chunk.solid; ++y) {
+        auto row = tiles.row(y);
+        for (int x = firstX; x < lastX; ++x) {
+            if (row[x] == 1) {
+                chunk.solid = true;
+                break;
+            }
+        }
+    }
+
+    // Empty chunks keep no texture and cost nothing to draw
+    if (!chunk.solid) {
+        if (chunk.texture) {
+            mFreeTextures.push_back(chunk.texture);
+            chunk.texture = nullptr;
+        }
+        return;
+    }
+
+    if (!chunk.texture) {
+        if (!mFreeTextures.empty()) {
+            chunk.texture = mFreeTextures.back();
+            mFreeTextures.pop_back();
+        } else {
+            int side = CHUNK_TILES * mTileSize;
+            chunk.texture = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, side, side);
+            if (!chunk.texture) {
+                // render() draws the tiles one by one instead
+                std::cerr << "Error creating chunk texture: " << SDL_GetError() << std::endl;
+                return;
+            }
+            SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+        }
+    }
+
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(mRenderer);
+    SDL_SetRenderTarget(mRenderer, chunk.texture);
+    SDL_SetRenderDrawColor(mRenderer, 0, 0, 0, 0);
+    SDL_RenderClear(mRenderer);
+    // Alpha is applied when the chunk is drawn, not baked in
+    drawTiles(tiles, firstX, firstY, 0, 0, 255);
+    SDL_SetRenderTarget(mRenderer, previousTarget);
+    ++mBakes;
+}
+
+template <typename Lookup>
+void ChunkCache::renderChunks(int cameraX, int cameraY, int width, int height, Lookup lookup) {
+    int chunkSize = CHUNK_TILES * mTileSize;
+    int startX = cameraX < 0 ? 0 : cameraX / chunkSize;
+    int startY = cameraY < 0 ? 0 : cameraY / chunkSize;
+    int endX = (cameraX + width - 1) / chunkSize;
+    int endY = (cameraY + height - 1) / chunkSize;
+
+    mCopies = 0;
+    for (int chunkY = startY; chunkY <= endY; ++chunkY) {
+        for (int chunkX = startX; chunkX <= endX; ++chunkX) {
+            TileGridView tiles;
+            int firstX;
+            int firstY;
+            if (!lookup(chunkX, chunkY, tiles, firstX, firstY)) {
+                continue;
+            }
+            Chunk& chunk = fetch(chunkX, chunkY);
+            if (chunk.dirty) {
+                bake(chunk, tiles, firstX, firstY);
+            }
+            if (!chunk.solid) {
+                continue;
+            }
+            int originX = chunkX * chunkSize - cameraX;
+            int originY = chunkY * chunkSize - cameraY;
+            if (chunk.texture) {
+                SDL_Rect dstRect = { originX, originY, chunkSize, chunkSize };
+                SDL_SetTextureAlphaMod(chunk.texture, mTint.a);
+                SDL_RenderCopy(mRenderer, chunk.texture, nullptr, &dstRect);
+                ++mCopies;
+            } else {
+                drawTiles(tiles, firstX, firstY, originX, originY, mTint.a);
+            }
+        }
+    }
+}
+
+void ChunkCache::render(const TileGrid& map, int cameraX, int cameraY, int width, int height) {
+    renderChunks(cameraX, cameraY, width, height, [&map](int chunkX, int chunkY, TileGridView& tiles, int& firstX, int& firstY) {
+        tiles = map;
+        firstX = chunkX * CHUNK_TILES;
+        firstY = chunkY * CHUNK_TILES;
+        return true;
+    });
+}
+
+void ChunkCache::render(const RegionPager& pager, int cameraX, int cameraY, int width, int height) {
+    renderChunks(cameraX, cameraY, width, height, [&pager](int chunkX, int chunkY, TileGridView& tiles, int& firstX, int& firstY) {
+        int tileX = chunkX * CHUNK_TILES;
+        int tileY = chunkY * CHUNK_TILES;
+        if (tileX >= pager.width() || tileY >= pager.height()) {
+            // Off the level: an empty view bakes as an empty chunk
+            tiles = TileGridView();
+            firstX = 0;
+            firstY = 0;
+            return true;
+        }
+        const TileGrid* region = pager.region(tileX, tileY, firstX, firstY);
+        if (!region) {
+            return false;
+        }
+        tiles = *region;
+        return true;
+    });
+}
+
+void ChunkCache::render(const ChunkSource& source, int cameraX, int cameraY, int width, int height) {
+    renderChunks(cameraX, cameraY, width, height, [this, &source](int chunkX, int chunkY, TileGridView& tiles, int& firstX, int& firstY) {
+        source(chunkX * CHUNK_TILES, chunkY * CHUNK_TILES, mSourceTiles);
+        tiles = mSourceTiles;
+        firstX = 0;
+        firstY = 0;
+        return true;
+    });
+}
+
+void ChunkCache::markDirty(int tileX, int tileY) {
+    if (tileX < 0 || tileY < 0) {
+        return;
+    }
+    auto found = mLookup.find(makeKey(tileX / CHUNK_TILES, tileY / CHUNK_TILES));
+    if (found != mLookup.end()) {
+        found->second->dirty = true;
+    }
+}
+
+void ChunkCache::markAllDirty() {
+    for (Chunk& chunk : mChunks) {
+        chunk.dirty = true;
+    }
+}
+
+void ChunkCache::setTint(Uint8 red, Uint8 green, Uint8 blue, Uint8 alpha) {
+    mTint = { red, green, blue, alpha };
+    markAllDirty();
+}
+
+int ChunkCache::getBakes() const {
+    return mBakes;
+}
+
+int ChunkCache::getEvictions() const {
+    return mEvictions;
+}
+
+int ChunkCache::getCopies() const {
+    return mCopies;
+}
+
+int ChunkCache::getResident() const {
+    return static_cast<int>(mChunks.size());
+}
@@ -0,0 +1,78 @@
+#include "parallax.h"
+#include <cmath>
+#include <utility>
+
+// Chunks each layer keeps; a screen shows at most 9
+const int LAYER_CACHE_SIZE = 16;
+
+Parallax::Parallax(SDL_Renderer* renderer, SDL_Texture* blockTexture, int tileSize)
+    : mRenderer(renderer), mBlockTexture(blockTexture), mTileSize(tileSize), mBackCopies(0), mFrontCopies(0) {}
+
+void Parallax::addLayer(TileGrid tiles, float scroll, bool front, SDL_Color tint) {
+    Layer layer;
+    layer.tiles = std::move(tiles);
+    layer.scroll = scroll;
+    layer.front = front;
+    layer.chunks.reset(new ChunkCache(mRenderer, mBlockTexture, mTileSize, LAYER_CACHE_SIZE));
+    layer.chunks->setTint(tint.r, tint.g, tint.b, tint.a);
+    mLayers.push_back(std::move(layer));
+}
+
+void Parallax::addLayer(ChunkCache::ChunkSource source, float scroll, bool front, SDL_Color tint) {
+    addLayer(TileGrid(), scroll, front, tint);
+    mLayers.back().source = std::move(source);
+}
+
+int Parallax::renderLayers(bool front, int cameraX, int cameraY, int width, int height) {
+    int copies = 0;
+    for (Layer& layer : mLayers) {
+        if (layer.front != front) {
+            continue;
+        }
+        int layerX = static_cast<int>(std::floor(cameraX * layer.scroll));
+        int layerY = static_cast<int>(std::floor(cameraY * layer.scroll));
+        if (layer.source) {
+            layer.chunks->render(layer.source, layerX, layerY, width, height);
+        } else {
+            layer.chunks->render(layer.tiles, layerX, layerY, width, height);
+        }
+        copies += layer.chunks->getCopies();
+    }
+    return copies;
+}
+
+void Parallax::renderBack(int cameraX, int cameraY, int width, int height) {
+    mBackCopies = renderLayers(false, cameraX, cameraY, width, height);
+}
+
+void Parallax::renderFront(int cameraX, int cameraY, int width, int height) {
+    mFrontCopies = renderLayers(true, cameraX, cameraY, width, height);
+}
+
+void Parallax::markAllDirty() {
+    for (Layer& layer : mLayers) {
+        layer.chunks->markAllDirty();
+    }
+}
+
+void Parallax::clear() {
+    for (Layer& layer : mLayers) {
+        layer.chunks->clear();
+    }
+}
+
+int Parallax::getLayerCount() const {
+    return static_cast<int>(mLayers.size());
+}
+
+int Parallax::getCopies() const {
+    return mBackCopies + mFrontCopies;
+}
+
+int Parallax::layerTiles(int mapTiles, int viewPixels, float scroll, int tileSize) {
+    // The playfield camera travels from 0 to mapTiles * tileSize - viewPixels
+    int travel = mapTiles * tileSize - viewPixels;
+    if (travel < 0) travel = 0;
+    int pixels = static_cast<int>(std::ceil(travel * scroll)) + viewPixels;
+    return (pixels + tileSize - 1) / tileSize;
+}
@@ -1,228 +1,544 @@
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_image.h>
-
-// Constants
-const int TILE_SIZE = 32;
-const int SCREEN_WIDTH = 800;  // Window width
-const int SCREEN_HEIGHT = 576; // Window height (18 tiles down * TILE_SIZE)
-
-// Player structure
-struct Player {
-    SDL_Rect rect = { 100, 100, TILE_SIZE, TILE_SIZE }; // Initial position and size
-    float velocityY = 0.0f;
-    bool onGround = false;
-};
-
-// Camera structure
-struct Camera {
-    int x = 0; // X position of the camera
-    int y = 0; // Y position of the camera (optional for vertical scrolling)
-    int width = SCREEN_WIDTH;
-    int height = SCREEN_HEIGHT;
-};
-
-// Function to load the map from a file
-std::vector<std::vector<int>> loadMap(const std::string& filename) {
-    std::vector<std::vector<int>> map;
-    std::ifstream file(filename);
-    std::string line;
-
-    while (std::getline(file, line)) {
-        std::vector<int> row;
-        for (char c : line) {
-            row.push_back(c - '0'); // Convert char to int
-        }
-        map.push_back(row);
-    }
-    return map;
-}
-
-// Function to update the camera position
-void updateCamera(Camera& camera, const Player& player, int mapWidth, int mapHeight) {
-    camera.x = player.rect.x + player.rect.w / 2 - camera.width / 2;
-    camera.y = player.rect.y + player.rect.h / 2 - camera.height / 2;
-
-    // Clamp camera position to map boundaries
-    if (camera.x < 0) camera.x = 0;
-    if (camera.y < 0) camera.y = 0;
-    if (camera.x + camera.width > mapWidth * TILE_SIZE) camera.x = mapWidth * TILE_SIZE - camera.width;
-    if (camera.y + camera.height > mapHeight * TILE_SIZE) camera.y = mapHeight * TILE_SIZE - camera.height;
-}
-
-// Function to render the map
-void renderMap(SDL_Renderer* renderer, SDL_Texture* blockTexture, const std::vector<std::vector<int>>& map, const Camera& camera) {
-    std::size_t startX = camera.x / TILE_SIZE;
-    std::size_t startY = camera.y / TILE_SIZE;
-    std::size_t endX = (camera.x + camera.width) / TILE_SIZE + 1;
-    std::size_t endY = (camera.y + camera.height) / TILE_SIZE + 1;
-
-    for (std::size_t y = startY; y < endY && y < map.size(); ++y) {
-        for (std::size_t x = startX; x < endX && x < map[y].size(); ++x) {
-            if (map[y][x] == 1) {
-                SDL_Rect dstRect = { 
-                    static_cast<int>(x * TILE_SIZE - camera.x), 
-                    static_cast<int>(y * TILE_SIZE - camera.y), 
-                    TILE_SIZE, TILE_SIZE 
-                };
-                SDL_RenderCopy(renderer, blockTexture, nullptr, &dstRect);
-            }
-        }
-    }
-}
-
-// Function to render the player
-void renderPlayer(SDL_Renderer* renderer, SDL_Texture* playerTexture, const Player& player, const Camera& camera) {
-    SDL_Rect dstRect = {
-        static_cast<int>(player.rect.x - camera.x),
-        static_cast<int>(player.rect.y - camera.y),
-        player.rect.w,
-        player.rect.h
-    };
-    SDL_RenderCopy(renderer, playerTexture, nullptr, &dstRect);
-}
-
-// Function to handle player movement and gravity
-void handlePlayerMovement(Player& player, const std::vector<std::vector<int>>& map, float deltaTime) {
-    const float GRAVITY = 300.0f; // Gravity strength
-    const float JUMP_VELOCITY = -400.0f; // Initial jump velocity
-    const float MOVE_SPEED = 400.0f; // Horizontal move speed (pixels per second)
-
-    const Uint8* keys = SDL_GetKeyboardState(nullptr);
-
-    // Horizontal movement
-    if (keys[SDL_SCANCODE_LEFT]) {
-        player.rect.x -= static_cast<int>(MOVE_SPEED * deltaTime); // Move left
-    }
-    if (keys[SDL_SCANCODE_RIGHT]) {
-        player.rect.x += static_cast<int>(MOVE_SPEED * deltaTime); // Move right
-    }
-
-    // Apply gravity
-    player.velocityY += GRAVITY * deltaTime; // Gravity affects vertical velocity
-    player.rect.y += static_cast<int>(player.velocityY * deltaTime); // Move vertically based on velocity
-
-    // Collision detection with the ground (horizontal and vertical)
-    player.onGround = false;
-    for (std::size_t y = 0; y < map.size(); ++y) {
-        for (std::size_t x = 0; x < map[y].size(); ++x) {
-            if (map[y][x] == 1) { // Check if the current tile is solid
-                SDL_Rect block = { 
-                    static_cast<int>(x * TILE_SIZE), 
-                    static_cast<int>(y * TILE_SIZE), 
-                    TILE_SIZE, TILE_SIZE 
-                };
-
-                // Horizontal collision (left/right movement)
-                if (SDL_HasIntersection(&player.rect, &block)) {
-                    if (player.rect.x < block.x) {  // Colliding from left side
-                        player.rect.x = block.x - player.rect.w;
-                    } else if (player.rect.x + player.rect.w > block.x + block.w) {  // Colliding from right side
-                        player.rect.x = block.x + block.w;
-                    }
-                }
-
-                // Vertical collision (up/down movement)
-                if (SDL_HasIntersection(&player.rect, &block)) {
-                    if (player.velocityY > 0) { // Falling down
-                        player.rect.y = block.y - player.rect.h;
-                        player.velocityY = 0; // Stop downward velocity
-                        player.onGround = true; // The player is standing on the ground
-                    }
-                }
-            }
-        }
-    }
-
-    // Jumping logic
-    if (player.onGround && keys[SDL_SCANCODE_SPACE]) {
-        player.velocityY = JUMP_VELOCITY; // Apply jump velocity when the player is on the ground
-    }
-}
-
-int main(int argc, char* argv[]) {
-    // Initialize SDL
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        std::cerr << "Error initializing SDL: " << SDL_GetError() << std::endl;
-        return 1;
-    }
-    if (IMG_Init(IMG_INIT_PNG) == 0) {
-        std::cerr << "Error initializing SDL_image: " << IMG_GetError() << std::endl;
-        SDL_Quit();
-        return 1;
-    }
-
-    SDL_Window* window = SDL_CreateWindow("Platformer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, 0);
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-
-    if (!window || !renderer) {
-        std::cerr << "Error creating SDL window or renderer: " << SDL_GetError() << std::endl;
-        IMG_Quit();
-        SDL_Quit();
-        return 1;
-    }
-
-    SDL_Texture* blockTexture = IMG_LoadTexture(renderer, "block.png");
-    SDL_Texture* playerTexture = IMG_LoadTexture(renderer, "player.png");
-
-    if (!blockTexture || !playerTexture) {
-        std::cerr << "Error loading textures: " << IMG_GetError() << std::endl;
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        IMG_Quit();
-        SDL_Quit();
-        return 1;
-    }
-
-    std::vector<std::vector<int>> map = loadMap("map.txt");
-    Player player;
-    Camera camera;
-
-    Uint32 lastTime = SDL_GetTicks();
-    bool running = true;
-
-    while (running) {
-        Uint32 currentTime = SDL_GetTicks();
-        float deltaTime = (currentTime - lastTime) / 1000.0f;
-        lastTime = currentTime;
-
-        // Cap deltaTime to prevent erratic movement
-        const float MAX_DELTA_TIME = 0.05f;  // 50ms per frame
-        deltaTime = std::min(deltaTime, MAX_DELTA_TIME);
-
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                running = false;
-            }
-        }
-
-        handlePlayerMovement(player, map, deltaTime);
-        updateCamera(camera, player, map[0].size(), map.size());
-
-        // Clear the screen
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
-
-        // Render map and player
-        renderMap(renderer, blockTexture, map, camera);
-        renderPlayer(renderer, playerTexture, player, camera);
-
-        // Present the rendered frame
-        SDL_RenderPresent(renderer);
-	SDL_Delay(15);
-    }
-
-    // Cleanup
-    SDL_DestroyTexture(blockTexture);
-    SDL_DestroyTexture(playerTexture);
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    IMG_Quit();
-    SDL_Quit();
-
-    return 0;
-}
-
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include "../../common/level_file.h"
+#include "../../common/region_pager.h"
+#include "../../common/tile_grid.h"
+#include "chunk_cache.h"
+#include "parallax.h"
+
+// Constants
+const int TILE_SIZE = 32;
+const int SCREEN_WIDTH = 800;  // Window width
+const int SCREEN_HEIGHT = 576; // Window height (18 tiles down * TILE_SIZE)
+const int CHUNK_CACHE_SIZE = 32; // Baked map chunks kept around the camera
+const int STREAM_REGIONS = 24;   // Regions of a streamed level kept in memory
+const int STREAM_REGION_SIZE = 128; // Tiles a side of generated streamed regions
+
+// Player structure
+struct Player {
+    SDL_Rect rect = { 100, 100, TILE_SIZE, TILE_SIZE }; // Initial position and size
+    float velocityY = 0.0f;
+    bool onGround = false;
+};
+
+// Camera structure
+struct Camera {
+    int x = 0; // X position of the camera
+    int y = 0; // Y position of the camera (optional for vertical scrolling)
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+};
+
+// Function to load the map from a file: a binary level (.lvl) or text
+// with one digit per tile. Levels are copied out of the mapping because
+// clicking edits the map.
+TileGrid loadMap(const std::string& filename) {
+    TileGrid map;
+    if (isLevelFile(filename)) {
+        LevelFile level;
+        if (level.open(filename)) {
+            copyGrid(level.layer<TileGrid::Tile>(0), map);
+        }
+    } else {
+        loadDigitGrid(filename, map);
+    }
+    return map;
+}
+
+// Parallax layers, back to front. A .lvl file's layers after the first
+// fill them in order; any it does not have are generated.
+struct LayerStyle {
+    float scroll;    // camera speed relative to the playfield
+    bool front;      // drawn over the player
+    SDL_Color tint;  // block colour and alpha
+};
+const LayerStyle PARALLAX_LAYERS[] = {
+    { 0.25f, false, { 50, 60, 100, 255 } },   // background hills
+    { 0.5f, false, { 100, 110, 150, 255 } },  // midground towers
+    { 1.5f, true, { 255, 255, 255, 80 } },    // foreground posts, see-through
+};
+const int PARALLAX_LAYER_COUNT = sizeof(PARALLAX_LAYERS) / sizeof(PARALLAX_LAYERS[0]);
+
+// Scenery for parallax layer index when the level has none: the row its
+// blocks start at in column x, for a layer height tiles tall
+int layerTop(int index, int x, int height) {
+    if (index == 0) {
+        // Rolling hills over the lower half
+        return height / 2 + static_cast<int>(std::sin(x * 0.11) * 3 + std::sin(x * 0.037) * 4);
+    } else if (index == 1) {
+        // Towers three tiles wide, every 14 tiles, of uneven heights
+        return x % 14 < 3 ? height - 4 - (x / 14 * 7) % (height / 2 + 1) : height;
+    }
+    // A post every 19 tiles
+    return x % 19 == 0 ? height - 2 - (x / 19) % 3 : height;
+}
+
+// Adds the parallax layers for the level in filename. Generated ones are
+// made a chunk at a time from layerTop(), so they cost no memory and run
+// on past the map's right edge; they are as tall as their camera can see
+// over a map of mapHeight tiles.
+void loadParallax(Parallax& parallax, const std::string& filename, int mapHeight) {
+    LevelFile level;
+    bool hasLayers = isLevelFile(filename) && level.open(filename);
+    for (int i = 0; i < PARALLAX_LAYER_COUNT; ++i) {
+        const LayerStyle& style = PARALLAX_LAYERS[i];
+        if (hasLayers && i + 1 < level.layers()) {
+            TileGrid tiles;
+            copyGrid(level.layer<TileGrid::Tile>(i + 1), tiles);
+            parallax.addLayer(std::move(tiles), style.scroll, style.front, style.tint);
+            continue;
+        }
+        int height = Parallax::layerTiles(mapHeight, SCREEN_HEIGHT, style.scroll, TILE_SIZE);
+        parallax.addLayer([i, height](int firstX, int firstY, TileGrid& tiles) {
+            for (int x = 0; x < tiles.width(); ++x) {
+                int top = layerTop(i, firstX + x, height);
+                for (int y = 0; y < tiles.height(); ++y) {
+                    tiles.at(x, y) = firstY + y >= top && firstY + y < height;
+                }
+            }
+        }, style.scroll, style.front, style.tint);
+    }
+}
+
+// Function to update the camera position
+void updateCamera(Camera& camera, const Player& player, int mapWidth, int mapHeight) {
+    camera.x = player.rect.x + player.rect.w / 2 - camera.width / 2;
+    camera.y = player.rect.y + player.rect.h / 2 - camera.height / 2;
+
+    // Clamp camera position to map boundaries
+    if (camera.x < 0) camera.x = 0;
+    if (camera.y < 0) camera.y = 0;
+    if (camera.x + camera.width > mapWidth * TILE_SIZE) camera.x = mapWidth * TILE_SIZE - camera.width;
+    if (camera.y + camera.height > mapHeight * TILE_SIZE) camera.y = mapHeight * TILE_SIZE - camera.height;
+}
+
+// Function to render the player
+void renderPlayer(SDL_Renderer* renderer, SDL_Texture* playerTexture, const Player& player, const Camera& camera) {
+    SDL_Rect dstRect = {
+        static_cast<int>(player.rect.x - camera.x),
+        static_cast<int>(player.rect.y - camera.y),
+        player.rect.w,
+        player.rect.h
+    };
+    SDL_RenderCopy(renderer, playerTexture, nullptr, &dstRect);
+}
+
+// Player physics
+const float GRAVITY = 300.0f; // Gravity strength
+const float JUMP_VELOCITY = -400.0f; // Initial jump velocity
+const float MOVE_SPEED = 400.0f; // Horizontal move speed (pixels per second)
+
+// Tile index containing pixel coordinate p, rounding down for negatives too
+int tileAt(int p) {
+    return p >= 0 ? p / TILE_SIZE : -((-p + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+// The collision functions take the map as a TileGrid or, for a streamed
+// level, a RegionPager; both read tiles with get().
+
+// Whether the tile at (tileX, tileY) is solid. Anything outside the map is open.
+template <typename Map>
+bool isSolid(const Map& map, int tileX, int tileY) {
+    return map.get(tileX, tileY) == 1;
+}
+
+// Whether any tile in column tileX between rows firstY and lastY is solid
+template <typename Map>
+bool columnBlocked(const Map& map, int tileX, int firstY, int lastY) {
+    for (int tileY = firstY; tileY <= lastY; ++tileY) {
+        if (isSolid(map, tileX, tileY)) return true;
+    }
+    return false;
+}
+
+// Whether any tile in row tileY between columns firstX and lastX is solid
+template <typename Map>
+bool rowBlocked(const Map& map, int tileY, int firstX, int lastX) {
+    for (int tileX = firstX; tileX <= lastX; ++tileX) {
+        if (isSolid(map, tileX, tileY)) return true;
+    }
+    return false;
+}
+
+// Moves the player dx pixels along X. Only the columns the leading edge
+// sweeps through are checked, nearest first, and the player stops flush
+// against the first solid one. Returns true when blocked.
+template <typename Map>
+bool sweepX(Player& player, const Map& map, int dx) {
+    SDL_Rect& r = player.rect;
+    int firstY = tileAt(r.y);
+    int lastY = tileAt(r.y + r.h - 1);
+    if (dx > 0) {
+        for (int tileX = tileAt(r.x + r.w - 1) + 1; tileX <= tileAt(r.x + r.w - 1 + dx); ++tileX) {
+            if (columnBlocked(map, tileX, firstY, lastY)) {
+                r.x = tileX * TILE_SIZE - r.w;
+                return true;
+            }
+        }
+    } else if (dx < 0) {
+        for (int tileX = tileAt(r.x) - 1; tileX >= tileAt(r.x + dx); --tileX) {
+            if (columnBlocked(map, tileX, firstY, lastY)) {
+                r.x = (tileX + 1) * TILE_SIZE;
+                return true;
+            }
+        }
+    }
+    r.x += dx;
+    return false;
+}
+
+// The same along Y, run after X has been resolved
+template <typename Map>
+bool sweepY(Player& player, const Map& map, int dy) {
+    SDL_Rect& r = player.rect;
+    int firstX = tileAt(r.x);
+    int lastX = tileAt(r.x + r.w - 1);
+    if (dy > 0) {
+        for (int tileY = tileAt(r.y + r.h - 1) + 1; tileY <= tileAt(r.y + r.h - 1 + dy); ++tileY) {
+            if (rowBlocked(map, tileY, firstX, lastX)) {
+                r.y = tileY * TILE_SIZE - r.h;
+                return true;
+            }
+        }
+    } else if (dy < 0) {
+        for (int tileY = tileAt(r.y) - 1; tileY >= tileAt(r.y + dy); --tileY) {
+            if (rowBlocked(map, tileY, firstX, lastX)) {
+                r.y = (tileY + 1) * TILE_SIZE;
+                return true;
+            }
+        }
+    }
+    r.y += dy;
+    return false;
+}
+
+// Moves the player for one frame. Collision only looks at the tiles the
+// player's box sweeps through, so the cost does not depend on map size.
+template <typename Map>
+void movePlayer(Player& player, const Map& map, float moveX, bool jump, float deltaTime) {
+    sweepX(player, map, static_cast<int>(moveX * deltaTime));
+
+    // Apply gravity
+    player.velocityY += GRAVITY * deltaTime;
+    int dy = static_cast<int>(player.velocityY * deltaTime);
+    if (sweepY(player, map, dy)) {
+        player.onGround = dy > 0;
+        player.velocityY = 0; // Landed or hit the ceiling
+    } else if (dy == 0 && player.velocityY >= 0) {
+        // Slow enough that this frame moved nothing; standing if a block is right below
+        const SDL_Rect& r = player.rect;
+        player.onGround = r.y % TILE_SIZE == 0 && rowBlocked(map, tileAt(r.y + r.h), tileAt(r.x), tileAt(r.x + r.w - 1));
+    } else {
+        player.onGround = false;
+    }
+
+    // Jumping logic
+    if (player.onGround && jump) {
+        player.velocityY = JUMP_VELOCITY; // Apply jump velocity when the player is on the ground
+    }
+}
+
+// Function to handle player movement and gravity
+template <typename Map>
+void handlePlayerMovement(Player& player, const Map& map, float deltaTime) {
+    const Uint8* keys = SDL_GetKeyboardState(nullptr);
+
+    float moveX = 0.0f;
+    if (keys[SDL_SCANCODE_LEFT]) moveX -= MOVE_SPEED;
+    if (keys[SDL_SCANCODE_RIGHT]) moveX += MOVE_SPEED;
+    movePlayer(player, map, moveX, keys[SDL_SCANCODE_SPACE], deltaTime);
+}
+
+// Tile (x, y) of the generated terrain for a map height tiles tall: a
+// solid floor with pits, and ledges scattered over the rest. The top left
+// stays open for the player's start.
+bool generatedSolid(int x, int y, int height) {
+    if (y >= height - 2) {
+        return (x / 8) % 7 != 3; // floor with a pit every 56 tiles
+    }
+    if (y > 6 && y % 6 == 0) {
+        return (x * 7 + y * 13) % 23 < 5; // ledges
+    }
+    return false;
+}
+
+// Writes a width x height map of generated terrain
+int generateMap(const char* path, int width, int height) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Error writing map: " << path << std::endl;
+        return 1;
+    }
+    std::string line(width, '0');
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            line[x] = generatedSolid(x, y, height) ? '1' : '0';
+        }
+        file << line << '\n';
+    }
+    return 0;
+}
+
+// Writes the same terrain straight to a streamed level in dir, a region
+// at a time, so the level can be far bigger than memory
+int generateRegions(const char* dir, int width, int height, int regionSize) {
+    if (!checkRegionSize(regionSize) || !makeDirectory(dir) || !writeRegionIndex(dir, width, height, regionSize)) {
+        return 1;
+    }
+    TileGrid region;
+    for (int regionY = 0; regionY * regionSize < height; ++regionY) {
+        for (int regionX = 0; regionX * regionSize < width; ++regionX) {
+            int firstX = regionX * regionSize;
+            int firstY = regionY * regionSize;
+            region.resize(std::min(regionSize, width - firstX), std::min(regionSize, height - firstY));
+            for (int y = 0; y < region.height(); ++y) {
+                for (int x = 0; x < region.width(); ++x) {
+                    region.at(x, y) = generatedSolid(firstX + x, firstY + y, height) ? 1 : 0;
+                }
+            }
+            if (!writeLevel(regionPath(dir, regionX, regionY), region)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// The collision loop handlePlayerMovement used to run: every solid tile in
+// the map, every frame. Kept to compare against.
+void collideFullScan(Player& player, const TileGrid& map) {
+    player.onGround = false;
+    for (int y = 0; y < map.height(); ++y) {
+        for (int x = 0; x < map.width(); ++x) {
+            if (map.at(x, y) == 1) {
+                SDL_Rect block = { static_cast<int>(x * TILE_SIZE), static_cast<int>(y * TILE_SIZE), TILE_SIZE, TILE_SIZE };
+                if (SDL_HasIntersection(&player.rect, &block)) {
+                    if (player.rect.x < block.x) {
+                        player.rect.x = block.x - player.rect.w;
+                    } else if (player.rect.x + player.rect.w > block.x + block.w) {
+                        player.rect.x = block.x + block.w;
+                    }
+                }
+                if (SDL_HasIntersection(&player.rect, &block)) {
+                    if (player.velocityY > 0) {
+                        player.rect.y = block.y - player.rect.h;
+                        player.velocityY = 0;
+                        player.onGround = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Per-frame movement cost on the given map with no window. The player runs
+// right and jumps whenever it lands, for a fixed number of 60 Hz frames.
+int runCollisionBench(const char* path, int frames) {
+    auto loadStart = std::chrono::steady_clock::now();
+    TileGrid map = loadMap(path);
+    auto loadEnd = std::chrono::steady_clock::now();
+    if (map.empty()) {
+        std::cerr << "Error loading map: " << path << std::endl;
+        return 1;
+    }
+    const float deltaTime = 1.0f / 60.0f;
+
+    Player player;
+    int landings = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        movePlayer(player, map, MOVE_SPEED, true, deltaTime);
+        landings += player.onGround;
+    }
+    auto mid = std::chrono::steady_clock::now();
+
+    // The old loop is far slower on big maps, so it gets fewer frames
+    int scanFrames = frames < 10 ? frames : 10;
+    Player scanned;
+    for (int frame = 0; frame < scanFrames; ++frame) {
+        scanned.rect.x += static_cast<int>(MOVE_SPEED * deltaTime);
+        scanned.velocityY += GRAVITY * deltaTime;
+        scanned.rect.y += static_cast<int>(scanned.velocityY * deltaTime);
+        collideFullScan(scanned, map);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double loadMs = std::chrono::duration<double, std::milli>(loadEnd - loadStart).count();
+    double localUs = std::chrono::duration<double, std::micro>(mid - start).count() / frames;
+    double scanUs = std::chrono::duration<double, std::micro>(end - mid).count() / scanFrames;
+    std::cout << "map:               " << path << " (" << map.width() << " x " << map.height() << " tiles, loaded in "
+              << loadMs << " ms)" << std::endl;
+    std::cout << "tile-local:        " << localUs << " us/frame over " << frames << " frames, " << landings
+              << " frames on ground, ended at " << player.rect.x << "," << player.rect.y << std::endl;
+    std::cout << "full scan:         " << scanUs << " us/frame over " << scanFrames << " frames" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--gen-map") == 0) {
+        const char* path = argc > 2 ? argv[2] : "huge_map.txt";
+        int width = argc > 3 ? std::atoi(argv[3]) : 10000;
+        int height = argc > 4 ? std::atoi(argv[4]) : 1000;
+        return generateMap(path, width, height);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--gen-regions") == 0) {
+        const char* dir = argc > 2 ? argv[2] : "huge_level";
+        int width = argc > 3 ? std::atoi(argv[3]) : 100000;
+        int height = argc > 4 ? std::atoi(argv[4]) : 1000;
+        int regionSize = argc > 5 ? std::atoi(argv[5]) : STREAM_REGION_SIZE;
+        return generateRegions(dir, width, height, regionSize);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-collision") == 0) {
+        return runCollisionBench(argc > 2 ? argv[2] : "map.txt", 6000);
+    }
+
+    // Initialize SDL
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "Error initializing SDL: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    if (IMG_Init(IMG_INIT_PNG) == 0) {
+        std::cerr << "Error initializing SDL_image: " << IMG_GetError() << std::endl;
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Window* window = SDL_CreateWindow("Platformer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+
+    if (!window || !renderer) {
+        std::cerr << "Error creating SDL window or renderer: " << SDL_GetError() << std::endl;
+        IMG_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Texture* blockTexture = IMG_LoadTexture(renderer, "block.png");
+    SDL_Texture* playerTexture = IMG_LoadTexture(renderer, "player.png");
+
+    if (!blockTexture || !playerTexture) {
+        std::cerr << "Error loading textures: " << IMG_GetError() << std::endl;
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        IMG_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    // A directory of regions is streamed in around the camera; anything
+    // else is loaded whole. Tiles of regions still loading are solid, so
+    // the player waits at their edge rather than falling through.
+    const char* mapFile = argc > 1 ? argv[1] : "map.txt";
+    bool streaming = isRegionLevel(mapFile);
+    TileGrid map;
+    RegionPager pager;
+    if (streaming) {
+        if (!pager.open(mapFile, STREAM_REGIONS, 1)) {
+            std::cerr << "Cannot stream level " << mapFile << std::endl;
+            SDL_DestroyTexture(blockTexture);
+            SDL_DestroyTexture(playerTexture);
+            SDL_DestroyRenderer(renderer);
+            SDL_DestroyWindow(window);
+            IMG_Quit();
+            SDL_Quit();
+            return 1;
+        }
+    } else {
+        map = loadMap(mapFile);
+    }
+    int mapWidth = streaming ? pager.width() : map.width();
+    int mapHeight = streaming ? pager.height() : map.height();
+    ChunkCache chunks(renderer, blockTexture, TILE_SIZE, CHUNK_CACHE_SIZE);
+    Parallax parallax(renderer, blockTexture, TILE_SIZE);
+    loadParallax(parallax, mapFile, mapHeight);
+    Player player;
+    Camera camera;
+
+    Uint32 lastTime = SDL_GetTicks();
+    bool running = true;
+
+    while (running) {
+        Uint32 currentTime = SDL_GetTicks();
+        float deltaTime = (currentTime - lastTime) / 1000.0f;
+        lastTime = currentTime;
+
+        // Cap deltaTime to prevent erratic movement
+        const float MAX_DELTA_TIME = 0.05f;  // 50ms per frame
+        deltaTime = std::min(deltaTime, MAX_DELTA_TIME);
+
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                running = false;
+            }
+            // Render targets lose their contents when the device resets
+            if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+                chunks.markAllDirty();
+                parallax.markAllDirty();
+            }
+            // Clicking toggles the block under the cursor; streamed levels are read-only
+            if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT && !streaming) {
+                int tileX = (event.button.x + camera.x) / TILE_SIZE;
+                int tileY = (event.button.y + camera.y) / TILE_SIZE;
+                if (map.inBounds(tileX, tileY)) {
+                    map.at(tileX, tileY) = map.at(tileX, tileY) == 1 ? 0 : 1;
+                    chunks.markDirty(tileX, tileY);
+                }
+            }
+        }
+
+        int previousCameraX = camera.x;
+        int previousCameraY = camera.y;
+        if (streaming) {
+            handlePlayerMovement(player, pager, deltaTime);
+        } else {
+            handlePlayerMovement(player, map, deltaTime);
+        }
+        updateCamera(camera, player, mapWidth, mapHeight);
+        if (streaming) {
+            // Fetch what is on screen, then a region further the way the camera is going
+            int directionX = camera.x > previousCameraX ? 1 : camera.x < previousCameraX ? -1 : 0;
+            int directionY = camera.y > previousCameraY ? 1 : camera.y < previousCameraY ? -1 : 0;
+            pager.update(tileAt(camera.x), tileAt(camera.y), camera.width / TILE_SIZE + 2, camera.height / TILE_SIZE + 2,
+                         directionX, directionY);
+        }
+
+        // Clear the screen
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+
+        // Render the scenery behind, the map and player, then the scenery in front
+        parallax.renderBack(camera.x, camera.y, camera.width, camera.height);
+        if (streaming) {
+            chunks.render(pager, camera.x, camera.y, camera.width, camera.height);
+        } else {
+            chunks.render(map, camera.x, camera.y, camera.width, camera.height);
+        }
+        renderPlayer(renderer, playerTexture, player, camera);
+        parallax.renderFront(camera.x, camera.y, camera.width, camera.height);
+
+        // Present the rendered frame
+        SDL_RenderPresent(renderer);
+	SDL_Delay(15);
+    }
+
+    // Cleanup
+    chunks.clear();
+    parallax.clear();
+    SDL_DestroyTexture(blockTexture);
+    SDL_DestroyTexture(playerTexture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    IMG_Quit();
+    SDL_Quit();
+
+    return 0;
+}
+
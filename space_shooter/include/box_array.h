@@ -0,0 +1,34 @@
+#ifndef BOX_ARRAY_H
+#define BOX_ARRAY_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <vector>
+
+// Structure-of-arrays storage for many moving boxes of one kind.
+//
+// Each field is its own contiguous array, so an update that only touches x
+// streams through x and active and nothing else, and the compiler can
+// vectorise it. Order is not kept: removal swaps the last box into the
+// hole. The usual frame is update loops that clear active, then one
+// removeInactive() pass.
+struct BoxArray {
+    std::vector<int> x;
+    std::vector<int> y;
+    std::vector<int> w;
+    std::vector<int> h;
+    std::vector<Uint8> active; // one byte per box, so loops over it vectorise
+
+    void reserve(std::size_t capacity);
+    void clear();
+    std::size_t size() const;
+
+    std::size_t add(int bx, int by, int bw, int bh);
+    void removeAt(std::size_t i);
+    // Swap-and-pop every box whose active flag is clear, in one pass
+    void removeInactive();
+
+    SDL_Rect rectAt(std::size_t i) const;
+};
+
+#endif // BOX_ARRAY_H
@@ -0,0 +1,49 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <vector>
+
+// Projectiles as plain particles: position and velocity, nothing else.
+//
+// Storage is four float arrays sized once for a fixed capacity; spawning
+// past it is refused rather than growing. update() moves every particle and
+// drops the ones that left the screen in the same pass. render() draws them
+// all with one SDL_RenderGeometry call using a single texture: the index
+// buffer and each vertex's colour and texture coordinates are written once
+// up front, so a frame only rewrites vertex positions.
+class ParticleArray {
+public:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> vx;
+    std::vector<float> vy;
+
+    // size is the side of each particle's square in pixels
+    ParticleArray(std::size_t capacity, float size);
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+    void clear();
+
+    // Returns false when the array is full
+    bool spawn(float px, float py, float pvx, float pvy);
+
+    // Moves every particle by its velocity and removes the ones wholly
+    // outside (0, 0, width, height). Order is not kept.
+    void update(float width, float height);
+
+    // Writes the vertex positions for the live particles
+    void buildVertices();
+    // Builds the vertices and draws every particle in one call
+    void render(SDL_Renderer* renderer, SDL_Texture* texture);
+
+private:
+    std::size_t mCount;
+    float mSize;
+    std::vector<SDL_Vertex> mVertices;
+    std::vector<int> mIndices;
+};
+
+#endif // PARTICLES_H
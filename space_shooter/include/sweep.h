@@ -0,0 +1,62 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "box_array.h"
+
+// One overlapping pair: index into the first BoxArray, index into the second
+struct HitPair {
+    Uint32 a;
+    Uint32 b;
+};
+
+// Sort-and-sweep along X between two sets of boxes.
+//
+// The first set (the many small ones, e.g. bullets) is split into
+// horizontal bands by top edge, and each band is sorted by left edge into
+// flat arrays. For a box of the second set, the first-set boxes in a band
+// that can overlap it on X are one contiguous run of that band. The
+// counting sort already knows where each left edge starts, so the run is
+// two lookups (binary search when the boxes are too spread out for a
+// counting sort), and only those runs in the bands it spans are tested.
+// In a side-scrolling shooter, where things are spread out along X, that
+// is a small slice of the set. Only boxes with their active flag set take part.
+// Overlap uses the same strict edges as checkCollision. Buffers are kept,
+// so steady frames do not allocate.
+class SortAndSweep {
+public:
+    SortAndSweep();
+
+    // Clears pairs and fills it with every overlapping (a, b)
+    void findPairs(const BoxArray& a, const BoxArray& b, std::vector<HitPair>& pairs);
+
+private:
+    void sortIntoBands(const BoxArray& boxes);
+    // Slot of the first box in band whose left edge is at or right of x
+    std::size_t firstAtOrAfter(std::size_t band, int x) const;
+
+    // The first set, active boxes only, ordered by (band, minX). Band k is
+    // entries mBandStart[k] to mBandStart[k + 1].
+    std::vector<int> mMinX;
+    std::vector<int> mMaxX;
+    std::vector<int> mMinY;
+    std::vector<int> mMaxY;
+    std::vector<Uint32> mIndex;
+    std::vector<Uint32> mBandStart;
+    int mTop;     // top of band 0
+    int mWidest;  // widest and tallest box in the first set
+    int mTallest;
+    int mLeft;    // leftmost left edge
+    long long mColumns; // left edges spanned, or 0 if std::sort was used
+
+    // Sort scratch. After a counting sort, entry k is where key k + 1
+    // starts, so it doubles as an index into the bands.
+    std::vector<Uint32> mCounts;
+    std::vector<std::pair<Uint64, Uint32>> mKeys;
+    // Every candidate pair is written here; only grows, so a frame never
+    // pays for resize() zeroing it
+    std::vector<HitPair> mCandidates;
+};
+
+#endif // SWEEP_H
@@ -0,0 +1,48 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <unordered_map>
+
+// Path-keyed, reference-counted texture cache.
+//
+// acquire() loads a BMP and uploads it the first time a path is asked for,
+// and hands back the same texture after that. release() only drops the
+// count; textures stay cached at zero so the next spawn costs nothing, and
+// are destroyed by purgeUnused() or clear(). A path that fails to load is
+// remembered too, so a missing file is not read again on every spawn.
+class TextureCache {
+public:
+    explicit TextureCache(SDL_Renderer* renderer);
+    ~TextureCache();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // May return null if the file could not be loaded
+    SDL_Texture* acquire(const std::string& path);
+    // Ignores null and textures the cache does not know
+    void release(SDL_Texture* texture);
+
+    // Destroys every texture nobody holds
+    void purgeUnused();
+    // Destroys everything; call before destroying the renderer
+    void clear();
+
+    // Files read from disk so far; stops growing once everything is warm
+    int getLoadCount() const;
+
+private:
+    struct Entry {
+        SDL_Texture* texture;
+        int refs;
+    };
+
+    SDL_Renderer* mRenderer;
+    std::unordered_map<std::string, Entry> mEntries;
+    std::unordered_map<SDL_Texture*, Entry*> mByTexture;
+    int mLoads;
+};
+
+#endif // TEXTURE_CACHE_H
@@ -0,0 +1,74 @@
+#ifndef WAVES_H
+#define WAVES_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "box_array.h"
+
+// Spawns enemies from a timeline of waves.
+//
+// A timeline file has one wave per line:
+//     TICK FORMATION COUNT Y SPACING
+// TICK is the frame it spawns on, FORMATION one of column, row, wedge,
+// grid or random, COUNT how many enemies, Y where the formation is
+// centred and SPACING the gap between neighbours in pixels. A line
+//     repeat TICKS
+// restarts the timeline every TICKS frames. # starts a comment.
+//
+// Enemies enter at the right edge and fly left at a fixed speed, so how
+// many are alive at once is known from the timeline alone. Reserving that
+// up front means even a wave of hundreds never grows the arrays mid-game.
+class WaveScheduler {
+public:
+    WaveScheduler(int screenWidth, int screenHeight, int enemySize);
+
+    // Replaces the timeline. On failure prints the line at fault and keeps
+    // the old one.
+    bool load(const std::string& path);
+    // One enemy at a random height every interval frames, forever
+    void useDefault(int interval);
+
+    // Spawns every wave due this frame, then advances one frame
+    void update(BoxArray& enemies);
+    void restart();
+
+    // Most enemies alive at once if none are shot, for enemies moving
+    // speed pixels a frame and removed once fully off the left edge
+    std::size_t getPeakConcurrency(int speed) const;
+    std::size_t getLargestWave() const;
+    int getLength() const;
+
+private:
+    enum Formation {
+        FORMATION_COLUMN, // stacked vertically at the right edge
+        FORMATION_ROW,    // one behind the other, trailing off screen
+        FORMATION_WEDGE,  // a V pointing left
+        FORMATION_GRID,   // a square block
+        FORMATION_RANDOM  // random heights along the right edge
+    };
+
+    struct Wave {
+        int tick;
+        Formation formation;
+        int count;
+        int y;
+        int spacing;
+    };
+
+    // Positions of a wave's enemies, in spawn order
+    template <typename Emit>
+    void layOut(const Wave& wave, Uint64& rng, Emit emit) const;
+
+    int mScreenWidth;
+    int mScreenHeight;
+    int mEnemySize;
+    std::vector<Wave> mWaves; // sorted by tick
+    int mRepeat;              // 0 for a timeline that plays once
+    int mTick;
+    std::size_t mNext;
+    Uint64 mRng;
+};
+
+#endif // WAVES_H
@@ -0,0 +1,60 @@
+#include "box_array.h"
+
+void BoxArray::reserve(std::size_t capacity) {
+    x.reserve(capacity);
+    y.reserve(capacity);
+    w.reserve(capacity);
+    h.reserve(capacity);
+    active.reserve(capacity);
+}
+
+void BoxArray::clear() {
+    x.clear();
+    y.clear();
+    w.clear();
+    h.clear();
+    active.clear();
+}
+
+std::size_t BoxArray::size() const {
+    return x.size();
+}
+
+std::size_t BoxArray::add(int bx, int by, int bw, int bh) {
+    x.push_back(bx);
+    y.push_back(by);
+    w.push_back(bw);
+    h.push_back(bh);
+    active.push_back(1);
+    return x.size() - 1;
+}
+
+void BoxArray::removeAt(std::size_t i) {
+    std::size_t last = x.size() - 1;
+    x[i] = x[last];
+    y[i] = y[last];
+    w[i] = w[last];
+    h[i] = h[last];
+    active[i] = active[last];
+    x.pop_back();
+    y.pop_back();
+    w.pop_back();
+    h.pop_back();
+    active.pop_back();
+}
+
+void BoxArray::removeInactive() {
+    std::size_t i = 0;
+    while (i < x.size()) {
+        if (active[i]) {
+            ++i;
+        } else {
+            // The box swapped in has not been looked at yet
+            removeAt(i);
+        }
+    }
+}
+
+SDL_Rect BoxArray::rectAt(std::size_t i) const {
+    return { x[i], y[i], w[i], h[i] };
+}
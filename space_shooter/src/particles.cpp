@@ -0,0 +1,101 @@
+#include "particles.h"
+
+ParticleArray::ParticleArray(std::size_t capacity, float size)
+    : x(capacity), y(capacity), vx(capacity), vy(capacity), mCount(0), mSize(size),
+      mVertices(capacity * 4), mIndices(capacity * 6) {
+    // Two triangles per quad, corners in the order top-left, top-right,
+    // bottom-right, bottom-left
+    for (std::size_t i = 0; i < capacity; ++i) {
+        SDL_Vertex* quad = &mVertices[i * 4];
+        for (int corner = 0; corner < 4; ++corner) {
+            quad[corner].color = { 255, 255, 255, 255 };
+        }
+        quad[0].tex_coord = { 0.0f, 0.0f };
+        quad[1].tex_coord = { 1.0f, 0.0f };
+        quad[2].tex_coord = { 1.0f, 1.0f };
+        quad[3].tex_coord = { 0.0f, 1.0f };
+
+        int base = static_cast<int>(i * 4);
+        int* index = &mIndices[i * 6];
+        index[0] = base;
+        index[1] = base + 1;
+        index[2] = base + 2;
+        index[3] = base;
+        index[4] = base + 2;
+        index[5] = base + 3;
+    }
+}
+
+std::size_t ParticleArray::size() const {
+    return mCount;
+}
+
+std::size_t ParticleArray::capacity() const {
+    return x.size();
+}
+
+void ParticleArray::clear() {
+    mCount = 0;
+}
+
+bool ParticleArray::spawn(float px, float py, float pvx, float pvy) {
+    if (mCount == x.size()) {
+        return false;
+    }
+    x[mCount] = px;
+    y[mCount] = py;
+    vx[mCount] = pvx;
+    vy[mCount] = pvy;
+    ++mCount;
+    return true;
+}
+
+void ParticleArray::update(float width, float height) {
+    float* px = x.data();
+    float* py = y.data();
+    float* pvx = vx.data();
+    float* pvy = vy.data();
+    const float left = -mSize;
+    const float top = -mSize;
+    std::size_t n = mCount;
+    std::size_t kept = 0;
+    // Every particle is written to slot kept and kept only advances for the
+    // ones still on screen, so there is no branch per particle
+    for (std::size_t i = 0; i < n; ++i) {
+        float nx = px[i] + pvx[i];
+        float ny = py[i] + pvy[i];
+        float nvx = pvx[i];
+        float nvy = pvy[i];
+        px[kept] = nx;
+        py[kept] = ny;
+        pvx[kept] = nvx;
+        pvy[kept] = nvy;
+        kept += (nx > left) & (nx < width) & (ny > top) & (ny < height);
+    }
+    mCount = kept;
+}
+
+void ParticleArray::buildVertices() {
+    const float* px = x.data();
+    const float* py = y.data();
+    SDL_Vertex* quad = mVertices.data();
+    for (std::size_t i = 0; i < mCount; ++i, quad += 4) {
+        float left = px[i];
+        float top = py[i];
+        float right = left + mSize;
+        float bottom = top + mSize;
+        quad[0].position = { left, top };
+        quad[1].position = { right, top };
+        quad[2].position = { right, bottom };
+        quad[3].position = { left, bottom };
+    }
+}
+
+void ParticleArray::render(SDL_Renderer* renderer, SDL_Texture* texture) {
+    if (mCount == 0) {
+        return;
+    }
+    buildVertices();
+    SDL_RenderGeometry(renderer, texture, mVertices.data(), static_cast<int>(mCount * 4),
+                       mIndices.data(), static_cast<int>(mCount * 6));
+}
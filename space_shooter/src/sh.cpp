@@ -1,6 +1,15 @@
 #include <SDL2/SDL.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 #include <iostream>
+#include "box_array.h"
+#include "particles.h"
+#include "sweep.h"
+#include "texture_cache.h"
+#include "waves.h"
 
 // Screen dimensions
 const int SCREEN_WIDTH = 800;
@@ -25,14 +34,11 @@ public:
     SDL_Rect rect; // Player position and size
     SDL_Texture* texture;
 
-    Player(SDL_Renderer* renderer) {
+    TextureCache& textures;
+
+    Player(TextureCache& textures) : textures(textures) {
         rect = {100, SCREEN_HEIGHT / 2 - 25, 50, 50};
-        SDL_Surface* surface = SDL_LoadBMP("player.bmp");
-        if (!surface) {
-            std::cerr << "Failed to load player asset: " << SDL_GetError() << std::endl;
-        }
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
+        texture = textures.acquire("player.bmp");
     }
 
     void handleInput(const Uint8* keyState) {
@@ -47,76 +53,375 @@ public:
     }
 
     ~Player() {
-        SDL_DestroyTexture(texture);
+        textures.release(texture);
     }
 };
 
-// Class for projectiles
-class Bullet {
-public:
-    SDL_Rect rect;
-    SDL_Texture* texture;
-    bool active;
+// Bullet and enemy sizes. Both live in BoxArrays rather than as objects.
+const int BULLET_SIZE = 10;
+const int ENEMY_SIZE = 50;
+
+// Enemy timeline, read from the working directory. Without it one enemy
+// arrives every DEFAULT_SPAWN_INTERVAL frames.
+const char* WAVES_FILE = "waves.txt";
+const int DEFAULT_SPAWN_INTERVAL = 21;
+
+// Sets up the spawner from the timeline file and sizes enemies for the
+// most that can ever be alive at once
+void setupWaves(WaveScheduler& waves, BoxArray& enemies, const char* path) {
+    if (!waves.load(path)) {
+        std::cerr << "Using the default spawn rate" << std::endl;
+        waves.useDefault(DEFAULT_SPAWN_INTERVAL);
+    }
+    enemies.reserve(waves.getPeakConcurrency(ENEMY_SPEED));
+}
 
-    Bullet(SDL_Renderer* renderer, int x, int y) {
-        rect = {x, y, 10, 10};
-        SDL_Surface* surface = SDL_LoadBMP("bullet.bmp");
-        if (!surface) {
-            std::cerr << "Failed to load bullet asset: " << SDL_GetError() << std::endl;
-        }
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
-        active = true;
+// Moves every bullet right; ones past the right edge are flagged inactive
+void updateBullets(BoxArray& bullets) {
+    int* x = bullets.x.data();
+    Uint8* active = bullets.active.data();
+    std::size_t n = bullets.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] += BULLET_SPEED;
+        active[i] &= x[i] <= SCREEN_WIDTH;
     }
+}
 
-    void update() {
-        rect.x += BULLET_SPEED;
-        if (rect.x > SCREEN_WIDTH) active = false;
+// Moves every enemy left; ones past the left edge are flagged inactive
+void updateEnemies(BoxArray& enemies) {
+    int* x = enemies.x.data();
+    const int* w = enemies.w.data();
+    Uint8* active = enemies.active.data();
+    std::size_t n = enemies.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] -= ENEMY_SPEED;
+        active[i] &= x[i] + w[i] >= 0;
     }
+}
 
-    void render(SDL_Renderer* renderer) {
-        SDL_RenderCopy(renderer, texture, nullptr, &rect);
+// Each bullet destroys at most one enemy and each enemy absorbs at most one
+// bullet; pairs whose bullet or enemy is already spent change nothing. Both
+// are only flagged here, the caller compacts the arrays afterwards. live is
+// 1 only when both are still active, so xor clears both without a branch.
+void resolveHits(BoxArray& bullets, BoxArray& enemies, const std::vector<HitPair>& hits) {
+    Uint8* bulletActive = bullets.active.data();
+    Uint8* enemyActive = enemies.active.data();
+    for (const HitPair& hit : hits) {
+        Uint8 live = bulletActive[hit.a] & enemyActive[hit.b];
+        bulletActive[hit.a] ^= live;
+        enemyActive[hit.b] ^= live;
+    }
+}
+
+// Particle bullets, for --bench-particles and --stress-particles. The
+// game's own bullets stay in a BoxArray, which the sort-and-sweep reads.
+const float PARTICLE_SIZE = 8.0f;
+const float PARTICLE_SPEED = 3.0f;
+
+// Keeps count particles alive, spawning replacements anywhere on screen
+// heading in a random direction
+void refillParticles(ParticleArray& particles, std::size_t count) {
+    while (particles.size() < count) {
+        float angle = static_cast<float>(rand()) / RAND_MAX * 6.2831853f;
+        particles.spawn(static_cast<float>(rand() % SCREEN_WIDTH), static_cast<float>(rand() % SCREEN_HEIGHT),
+                        std::cos(angle) * PARTICLE_SPEED, std::sin(angle) * PARTICLE_SPEED);
     }
+}
 
-    ~Bullet() {
-        SDL_DestroyTexture(texture);
+// Draws every box in the array with one texture
+void renderBoxes(SDL_Renderer* renderer, SDL_Texture* texture, const BoxArray& boxes) {
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        SDL_Rect rect = boxes.rectAt(i);
+        SDL_RenderCopy(renderer, texture, nullptr, &rect);
     }
-};
+}
 
-// Class for enemies
-class Enemy {
-public:
+// Bullet update throughput with no window: SoA storage against the old
+// heap-allocated Bullet objects held by pointer. Bullets leaving the screen
+// are removed and respawned at the left edge so the count stays constant.
+struct PointerBullet {
     SDL_Rect rect;
     SDL_Texture* texture;
     bool active;
+};
+
+int runBench(int count, int steps) {
+    BoxArray bullets;
+    bullets.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        bullets.add(rand() % SCREEN_WIDTH, rand() % SCREEN_HEIGHT, BULLET_SIZE, BULLET_SIZE);
+    }
+    std::vector<PointerBullet*> pointerBullets;
+    for (int i = 0; i < count; ++i) {
+        pointerBullets.push_back(new PointerBullet{ bullets.rectAt(i), nullptr, true });
+    }
 
-    Enemy(SDL_Renderer* renderer, int x, int y) {
-        rect = {x, y, 50, 50};
-        SDL_Surface* surface = SDL_LoadBMP("enemy.bmp");
-        if (!surface) {
-            std::cerr << "Failed to load enemy asset: " << SDL_GetError() << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    long long soaRespawned = 0;
+    for (int step = 0; step < steps; ++step) {
+        updateBullets(bullets);
+        bullets.removeInactive();
+        while (bullets.size() < static_cast<std::size_t>(count)) {
+            bullets.add(0, rand() % SCREEN_HEIGHT, BULLET_SIZE, BULLET_SIZE);
+            ++soaRespawned;
         }
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
-        active = true;
     }
+    auto mid = std::chrono::steady_clock::now();
+
+    // The loop sh.cpp used to run: update through the pointer, erase dead
+    // bullets in place, then allocate replacements
+    long long pointerRespawned = 0;
+    for (int step = 0; step < steps; ++step) {
+        for (auto it = pointerBullets.begin(); it != pointerBullets.end();) {
+            (*it)->rect.x += BULLET_SPEED;
+            if ((*it)->rect.x > SCREEN_WIDTH) (*it)->active = false;
+            if (!(*it)->active) {
+                delete *it;
+                it = pointerBullets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        while (pointerBullets.size() < static_cast<std::size_t>(count)) {
+            pointerBullets.push_back(new PointerBullet{ { 0, rand() % SCREEN_HEIGHT, BULLET_SIZE, BULLET_SIZE }, nullptr, true });
+            ++pointerRespawned;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    for (auto& bullet : pointerBullets) delete bullet;
+
+    double updates = static_cast<double>(count) * steps;
+    double soaNs = std::chrono::duration<double, std::nano>(mid - start).count();
+    double pointerNs = std::chrono::duration<double, std::nano>(end - mid).count();
+    std::cout << "bullets:           " << count << " x " << steps << " steps" << std::endl;
+    std::cout << "SoA:               " << soaNs / updates << " ns/bullet, " << updates / soaNs * 1e3 << " M bullets/s, "
+              << soaRespawned << " respawned" << std::endl;
+    std::cout << "pointer + erase:   " << pointerNs / updates << " ns/bullet, " << updates / pointerNs * 1e3 << " M bullets/s, "
+              << pointerRespawned << " respawned" << std::endl;
+    return 0;
+}
 
-    void update() {
-        rect.x -= ENEMY_SPEED;
-        if (rect.x + rect.w < 0) active = false;
+// Bullets against enemies scattered over the screen: every overlapping
+// pair by brute force, then by sort-and-sweep, plus the whole
+// find/resolve/compact step the game runs each frame.
+int runCollisionBench(int bulletCount, int enemyCount, int passes) {
+    BoxArray bullets;
+    BoxArray enemies;
+    for (int i = 0; i < bulletCount; ++i) {
+        bullets.add(rand() % SCREEN_WIDTH, rand() % SCREEN_HEIGHT, BULLET_SIZE, BULLET_SIZE);
+    }
+    for (int i = 0; i < enemyCount; ++i) {
+        enemies.add(rand() % SCREEN_WIDTH, rand() % SCREEN_HEIGHT, ENEMY_SIZE, ENEMY_SIZE);
     }
 
-    void render(SDL_Renderer* renderer) {
-        SDL_RenderCopy(renderer, texture, nullptr, &rect);
+    auto start = std::chrono::steady_clock::now();
+    std::size_t brutePairs = 0;
+    for (int pass = 0; pass < passes; ++pass) {
+        brutePairs = 0;
+        for (std::size_t i = 0; i < bullets.size(); ++i) {
+            SDL_Rect bulletRect = bullets.rectAt(i);
+            for (std::size_t j = 0; j < enemies.size(); ++j) {
+                if (checkCollision(bulletRect, enemies.rectAt(j))) {
+                    ++brutePairs;
+                }
+            }
+        }
     }
+    auto mid = std::chrono::steady_clock::now();
 
-    ~Enemy() {
-        SDL_DestroyTexture(texture);
+    SortAndSweep sweep;
+    std::vector<HitPair> hits;
+    for (int pass = 0; pass < passes; ++pass) {
+        sweep.findPairs(bullets, enemies, hits);
     }
-};
+    auto end = std::chrono::steady_clock::now();
+    std::size_t sweepPairs = hits.size();
+
+    // One full frame's worth: find, resolve, compact. Each pass starts from
+    // a fresh copy, made outside the timing.
+    BoxArray bulletsLeft;
+    BoxArray enemiesLeft;
+    double stepUs = 0.0;
+    for (int pass = 0; pass < passes; ++pass) {
+        bulletsLeft = bullets;
+        enemiesLeft = enemies;
+        auto stepStart = std::chrono::steady_clock::now();
+        sweep.findPairs(bulletsLeft, enemiesLeft, hits);
+        resolveHits(bulletsLeft, enemiesLeft, hits);
+        bulletsLeft.removeInactive();
+        enemiesLeft.removeInactive();
+        stepUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - stepStart).count();
+    }
+    stepUs /= passes;
+
+    double bruteUs = std::chrono::duration<double, std::micro>(mid - start).count() / passes;
+    double sweepUs = std::chrono::duration<double, std::micro>(end - mid).count() / passes;
+    std::cout << "bullets x enemies: " << bulletCount << " x " << enemyCount << std::endl;
+    std::cout << "brute force:       " << bruteUs << " us, " << brutePairs << " pairs" << std::endl;
+    std::cout << "sort and sweep:    " << sweepUs << " us, " << sweepPairs << " pairs" << std::endl;
+    std::cout << "full step:         " << stepUs << " us, " << (bulletCount - bulletsLeft.size()) << " bullets and "
+              << (enemyCount - enemiesLeft.size()) << " enemies destroyed" << std::endl;
+    return brutePairs == sweepPairs ? 0 : 1;
+}
+
+// Particle bullet throughput with no window: the move-and-cull pass and
+// the vertex positions render() would write, at a constant live count
+int runParticleBench(int count, int steps) {
+    ParticleArray particles(count, PARTICLE_SIZE);
+    refillParticles(particles, count);
+
+    double updateNs = 0.0;
+    double vertexNs = 0.0;
+    long long respawned = 0;
+    for (int step = 0; step < steps; ++step) {
+        auto start = std::chrono::steady_clock::now();
+        particles.update(SCREEN_WIDTH, SCREEN_HEIGHT);
+        auto mid = std::chrono::steady_clock::now();
+        particles.buildVertices();
+        auto end = std::chrono::steady_clock::now();
+        updateNs += std::chrono::duration<double, std::nano>(mid - start).count();
+        vertexNs += std::chrono::duration<double, std::nano>(end - mid).count();
+        respawned += count - particles.size();
+        refillParticles(particles, count);
+    }
+
+    double updates = static_cast<double>(count) * steps;
+    std::cout << "particles:         " << count << " x " << steps << " steps" << std::endl;
+    std::cout << "move and cull:     " << updateNs / updates << " ns/particle, " << updateNs / steps / 1e6 << " ms/frame, "
+              << respawned << " culled" << std::endl;
+    std::cout << "vertices:          " << vertexNs / updates << " ns/particle, " << vertexNs / steps / 1e6 << " ms/frame" << std::endl;
+    return 0;
+}
+
+// Draws count live particles through the software renderer for the given
+// number of frames, without vsync, and reports the frame rate. Set
+// SDL_VIDEODRIVER=dummy to run it with no display.
+int runParticleStress(int count, int frames) {
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    SDL_Window* window = SDL_CreateWindow("Harrier Clone", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+    if (!window) {
+        std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << std::endl;
+        SDL_Quit();
+        return 1;
+    }
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    if (!renderer) {
+        std::cerr << "SDL_CreateRenderer Error: " << SDL_GetError() << std::endl;
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 1;
+    }
+
+    TextureCache textures(renderer);
+    SDL_Texture* bulletTexture = textures.acquire("bullet.bmp");
+    ParticleArray particles(count, PARTICLE_SIZE);
+    refillParticles(particles, count);
+
+    double updateMs = 0.0;
+    double renderMs = 0.0;
+    double worstMs = 0.0;
+    SDL_Event event;
+    for (int frame = 0; frame < frames; ++frame) {
+        while (SDL_PollEvent(&event)) {
+        }
+        auto start = std::chrono::steady_clock::now();
+        particles.update(SCREEN_WIDTH, SCREEN_HEIGHT);
+        refillParticles(particles, count);
+        auto mid = std::chrono::steady_clock::now();
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        particles.render(renderer, bulletTexture);
+        SDL_RenderPresent(renderer);
+        auto end = std::chrono::steady_clock::now();
+        updateMs += std::chrono::duration<double, std::milli>(mid - start).count();
+        renderMs += std::chrono::duration<double, std::milli>(end - mid).count();
+        worstMs = std::max(worstMs, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    double frameMs = (updateMs + renderMs) / frames;
+    std::cout << "particles:         " << count << " x " << frames << " frames, software renderer" << std::endl;
+    std::cout << "update:            " << updateMs / frames << " ms/frame" << std::endl;
+    std::cout << "render:            " << renderMs / frames << " ms/frame" << std::endl;
+    std::cout << "frame:             " << frameMs << " ms average, " << worstMs << " ms worst, "
+              << (frameMs > 0.0 ? 1000.0 / frameMs : 0.0) << " FPS" << std::endl;
+
+    textures.release(bulletTexture);
+    textures.clear();
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
+
+// Plays a wave timeline with no window and checks that spawning stays
+// inside the storage reserved for it. Enemies are never shot here, which
+// is the worst case the reservation is sized for.
+int runWaveBench(const char* path, int periods) {
+    WaveScheduler waves(SCREEN_WIDTH, SCREEN_HEIGHT, ENEMY_SIZE);
+    BoxArray enemies;
+    setupWaves(waves, enemies, path);
+    const std::size_t reserved = enemies.x.capacity();
+    const int* storage = enemies.x.data();
+
+    std::size_t peak = 0;
+    int reallocations = 0;
+    double worstSpawnUs = 0.0;
+    long long spawned = 0;
+    long long frames = static_cast<long long>(waves.getLength()) * periods;
+    for (long long frame = 0; frame < frames; ++frame) {
+        std::size_t before = enemies.size();
+        auto start = std::chrono::steady_clock::now();
+        waves.update(enemies);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        worstSpawnUs = std::max(worstSpawnUs, us);
+        spawned += enemies.size() - before;
+        if (enemies.x.data() != storage) {
+            ++reallocations;
+            storage = enemies.x.data();
+        }
+        peak = std::max(peak, enemies.size());
+        updateEnemies(enemies);
+        enemies.removeInactive();
+    }
+
+    std::cout << "timeline:          " << path << " (" << waves.getLength() << " frames x " << periods << ")" << std::endl;
+    std::cout << "largest wave:      " << waves.getLargestWave() << std::endl;
+    std::cout << "enemies spawned:   " << spawned << std::endl;
+    std::cout << "peak alive:        " << peak << " (reserved " << reserved << ")" << std::endl;
+    std::cout << "worst spawn frame: " << worstSpawnUs << " us" << std::endl;
+    std::cout << "reallocations:     " << reallocations << std::endl;
+    return reallocations == 0 && peak <= reserved ? 0 : 1;
+}
 
 // Main game function
 int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        int count = argc > 2 ? std::atoi(argv[2]) : 100000;
+        int steps = argc > 3 ? std::atoi(argv[3]) : 100;
+        return runBench(count, steps);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-particles") == 0) {
+        int count = argc > 2 ? std::atoi(argv[2]) : 50000;
+        int steps = argc > 3 ? std::atoi(argv[3]) : 600;
+        return runParticleBench(count, steps);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--stress-particles") == 0) {
+        int count = argc > 2 ? std::atoi(argv[2]) : 50000;
+        int frames = argc > 3 ? std::atoi(argv[3]) : 600;
+        return runParticleStress(count, frames);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-waves") == 0) {
+        return runWaveBench(argc > 2 ? argv[2] : WAVES_FILE, 10);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-collision") == 0) {
+        int bullets = argc > 2 ? std::atoi(argv[2]) : 5000;
+        int enemies = argc > 3 ? std::atoi(argv[3]) : 2000;
+        return runCollisionBench(bullets, enemies, 100);
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
         return 1;
@@ -137,14 +442,21 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Initialize game objects
-    Player player(renderer);
-    std::vector<Bullet*> bullets;
-    std::vector<Enemy*> enemies;
+    // Initialize game objects. Textures are shared through the cache, so
+    // spawning only loads a file the first time it is used.
+    TextureCache textures(renderer);
+    Player player(textures);
+    SDL_Texture* bulletTexture = textures.acquire("bullet.bmp");
+    SDL_Texture* enemyTexture = textures.acquire("enemy.bmp");
+    BoxArray bullets;
+    BoxArray enemies;
+    SortAndSweep sweep;
+    std::vector<HitPair> hits;
 
     bool running = true;
     SDL_Event event;
-    int enemySpawnTimer = 0;
+    WaveScheduler waves(SCREEN_WIDTH, SCREEN_HEIGHT, ENEMY_SIZE);
+    setupWaves(waves, enemies, WAVES_FILE);
 
     while (running) {
         while (SDL_PollEvent(&event)) {
@@ -154,7 +466,7 @@ int main(int argc, char* argv[]) {
 
             // Handle shooting
             if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) {
-                bullets.push_back(new Bullet(renderer, player.rect.x + player.rect.w, player.rect.y + player.rect.h / 2 - 5));
+                bullets.add(player.rect.x + player.rect.w, player.rect.y + player.rect.h / 2 - 5, BULLET_SIZE, BULLET_SIZE);
             }
         }
 
@@ -162,70 +474,40 @@ int main(int argc, char* argv[]) {
         player.handleInput(keyState);
 
         // Update bullets
-        for (auto it = bullets.begin(); it != bullets.end();) {
-            (*it)->update();
-            if (!(*it)->active) {
-                delete *it;
-                it = bullets.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        updateBullets(bullets);
+        bullets.removeInactive();
 
         // Spawn enemies
-        enemySpawnTimer++;
-        if (enemySpawnTimer > 20) { // Adjust spawn rate here
-            enemies.push_back(new Enemy(renderer, SCREEN_WIDTH, rand() % (SCREEN_HEIGHT - 50)));
-            enemySpawnTimer = 0;
-        }
+        waves.update(enemies);
 
         // Update enemies
-        for (auto it = enemies.begin(); it != enemies.end();) {
-            (*it)->update();
-            if (!(*it)->active) {
-                delete *it;
-                it = enemies.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        updateEnemies(enemies);
+        enemies.removeInactive();
 
         // Check collisions
-        for (auto bulletIt = bullets.begin(); bulletIt != bullets.end();) {
-            bool bulletRemoved = false;
-            for (auto enemyIt = enemies.begin(); enemyIt != enemies.end();) {
-                if (checkCollision((*bulletIt)->rect, (*enemyIt)->rect)) {
-                    delete *bulletIt;
-                    bulletIt = bullets.erase(bulletIt);
-                    delete *enemyIt;
-                    enemyIt = enemies.erase(enemyIt);
-                    bulletRemoved = true;
-                    break;
-                } else {
-                    ++enemyIt;
-                }
-            }
-            if (!bulletRemoved) ++bulletIt;
-        }
+        sweep.findPairs(bullets, enemies, hits);
+        resolveHits(bullets, enemies, hits);
+        bullets.removeInactive();
+        enemies.removeInactive();
 
         // Render
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
         player.render(renderer);
-        for (auto& bullet : bullets) bullet->render(renderer);
-        for (auto& enemy : enemies) enemy->render(renderer);
+        renderBoxes(renderer, bulletTexture, bullets);
+        renderBoxes(renderer, enemyTexture, enemies);
 
         SDL_RenderPresent(renderer);
     }
 
     // Clean up
-    for (auto& bullet : bullets) delete bullet;
-    for (auto& enemy : enemies) delete enemy;
+    textures.release(bulletTexture);
+    textures.release(enemyTexture);
+    textures.clear();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
 
     return 0;
 }
-
@@ -0,0 +1,163 @@
+#include "sweep.h"
+#include <algorithm>
+
+// Height of one band of the first set, a little taller than a big sprite
+const int BAND_HEIGHT = 64;
+
+// On screen the (band, left edge) keys span a few thousand values, so a
+// counting sort is one linear pass; anything more spread out uses std::sort
+const long long COUNTING_SORT_MAX_KEYS = 1 << 16;
+
+SortAndSweep::SortAndSweep() : mTop(0), mWidest(0), mTallest(0), mLeft(0), mColumns(0) {}
+
+void SortAndSweep::sortIntoBands(const BoxArray& boxes) {
+    std::size_t n = 0;
+    int left = 0;
+    int right = 0;
+    int bottom = 0;
+    mTop = 0;
+    mWidest = 0;
+    mTallest = 0;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        if (boxes.active[i]) {
+            if (n == 0 || boxes.x[i] < left) left = boxes.x[i];
+            if (n == 0 || boxes.x[i] > right) right = boxes.x[i];
+            if (n == 0 || boxes.y[i] < mTop) mTop = boxes.y[i];
+            if (n == 0 || boxes.y[i] > bottom) bottom = boxes.y[i];
+            if (boxes.w[i] > mWidest) mWidest = boxes.w[i];
+            if (boxes.h[i] > mTallest) mTallest = boxes.h[i];
+            ++n;
+        }
+    }
+    mMinX.resize(n);
+    mMaxX.resize(n);
+    mMinY.resize(n);
+    mMaxY.resize(n);
+    mIndex.resize(n);
+    std::size_t bands = n > 0 ? (static_cast<long long>(bottom) - mTop) / BAND_HEIGHT + 1 : 0;
+    mBandStart.assign(bands + 1, 0);
+    mLeft = left;
+    mColumns = 0;
+    if (n == 0) {
+        return;
+    }
+
+    auto place = [&](std::size_t slot, std::size_t i) {
+        mMinX[slot] = boxes.x[i];
+        mMaxX[slot] = boxes.x[i] + boxes.w[i];
+        mMinY[slot] = boxes.y[i];
+        mMaxY[slot] = boxes.y[i] + boxes.h[i];
+        mIndex[slot] = static_cast<Uint32>(i);
+    };
+    auto bandOf = [&](std::size_t i) {
+        return static_cast<std::size_t>((static_cast<long long>(boxes.y[i]) - mTop) / BAND_HEIGHT);
+    };
+
+    long long columns = static_cast<long long>(right) - left + 1;
+    if (columns * static_cast<long long>(bands) <= COUNTING_SORT_MAX_KEYS) {
+        mColumns = columns;
+        mCounts.assign(static_cast<std::size_t>(columns * bands) + 1, 0);
+        auto keyOf = [&](std::size_t i) {
+            return bandOf(i) * static_cast<std::size_t>(columns) + static_cast<std::size_t>(boxes.x[i] - left);
+        };
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            if (boxes.active[i]) {
+                ++mCounts[keyOf(i) + 1];
+            }
+        }
+        for (std::size_t k = 1; k < mCounts.size(); ++k) {
+            mCounts[k] += mCounts[k - 1];
+        }
+        for (std::size_t band = 0; band <= bands; ++band) {
+            mBandStart[band] = mCounts[band * static_cast<std::size_t>(columns)];
+        }
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            if (boxes.active[i]) {
+                place(mCounts[keyOf(i)]++, i);
+            }
+        }
+    } else {
+        // Band in the high half, left edge in the low half; flipping the
+        // sign bit keeps negative edges in order as unsigned
+        mKeys.clear();
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            if (boxes.active[i]) {
+                Uint32 edge = static_cast<Uint32>(boxes.x[i]) ^ 0x80000000u;
+                mKeys.push_back({ static_cast<Uint64>(bandOf(i)) << 32 | edge, static_cast<Uint32>(i) });
+                ++mBandStart[bandOf(i) + 1];
+            }
+        }
+        std::sort(mKeys.begin(), mKeys.end());
+        for (std::size_t slot = 0; slot < n; ++slot) {
+            place(slot, mKeys[slot].second);
+        }
+        for (std::size_t band = 1; band <= bands; ++band) {
+            mBandStart[band] += mBandStart[band - 1];
+        }
+    }
+}
+
+std::size_t SortAndSweep::firstAtOrAfter(std::size_t band, int x) const {
+    if (mColumns > 0) {
+        // Placing each box advanced its key's start to the next key's, so
+        // key k starts at mCounts[k - 1]
+        long long column = std::min(std::max(static_cast<long long>(x) - mLeft, 0LL), mColumns);
+        std::size_t key = band * static_cast<std::size_t>(mColumns) + static_cast<std::size_t>(column);
+        return key == 0 ? 0 : mCounts[key - 1];
+    }
+    auto bandEnd = mMinX.begin() + mBandStart[band + 1];
+    return std::lower_bound(mMinX.begin() + mBandStart[band], bandEnd, x) - mMinX.begin();
+}
+
+void SortAndSweep::findPairs(const BoxArray& a, const BoxArray& b, std::vector<HitPair>& pairs) {
+    pairs.clear();
+    sortIntoBands(a);
+    if (mIndex.empty()) {
+        return;
+    }
+
+    const long long lastBand = static_cast<long long>(mBandStart.size()) - 2;
+    const int* maxX = mMaxX.data();
+    const int* minY = mMinY.data();
+    const int* maxY = mMaxY.data();
+    const Uint32* index = mIndex.data();
+    std::size_t count = 0;
+    for (std::size_t j = 0; j < b.size(); ++j) {
+        if (!b.active[j]) {
+            continue;
+        }
+        int bMinX = b.x[j];
+        int bMaxX = b.x[j] + b.w[j];
+        int bMinY = b.y[j];
+        int bMaxY = b.y[j] + b.h[j];
+
+        // Bands holding a box whose top edge is within reach of this one
+        long long firstBand = (static_cast<long long>(bMinY) - mTallest + 1 - mTop) / BAND_HEIGHT;
+        long long endBand = static_cast<long long>(bMaxY) - 1 - mTop;
+        if (endBand < 0) {
+            continue;
+        }
+        endBand = std::min(endBand / BAND_HEIGHT, lastBand);
+        firstBand = std::max(firstBand, 0LL);
+
+        for (long long band = firstBand; band <= endBand; ++band) {
+            // Every box that can reach this one starts less than the widest
+            // box's width to its left, and before its right edge
+            std::size_t lo = firstAtOrAfter(band, bMinX - mWidest + 1);
+            std::size_t hi = std::max(lo, firstAtOrAfter(band, bMaxX));
+
+            // Every candidate is written and the count only advances on a
+            // hit, so the loop has no data-dependent branch to mispredict
+            if (mCandidates.size() < count + (hi - lo)) {
+                mCandidates.resize(std::max(count + (hi - lo), mCandidates.size() * 2));
+            }
+            HitPair* out = mCandidates.data();
+            Uint32 bIndex = static_cast<Uint32>(j);
+            for (std::size_t k = lo; k < hi; ++k) {
+                out[count] = { index[k], bIndex };
+                count += (maxX[k] > bMinX) & (minY[k] < bMaxY) & (maxY[k] > bMinY);
+            }
+        }
+    }
+    pairs.assign(mCandidates.begin(), mCandidates.begin() + count);
+}
@@ -0,0 +1,75 @@
+#include "texture_cache.h"
+#include <iostream>
+
+TextureCache::TextureCache(SDL_Renderer* renderer) : mRenderer(renderer), mLoads(0) {}
+
+TextureCache::~TextureCache() {
+    clear();
+}
+
+SDL_Texture* TextureCache::acquire(const std::string& path) {
+    auto found = mEntries.find(path);
+    if (found != mEntries.end()) {
+        Entry& entry = found->second;
+        if (entry.texture) {
+            ++entry.refs;
+        }
+        return entry.texture;
+    }
+
+    ++mLoads;
+    SDL_Texture* texture = nullptr;
+    SDL_Surface* surface = SDL_LoadBMP(path.c_str());
+    if (!surface) {
+        std::cerr << "Failed to load " << path << ": " << SDL_GetError() << std::endl;
+    } else {
+        texture = SDL_CreateTextureFromSurface(mRenderer, surface);
+        if (!texture) {
+            std::cerr << "Failed to create texture from " << path << ": " << SDL_GetError() << std::endl;
+        }
+        SDL_FreeSurface(surface);
+    }
+
+    Entry& entry = mEntries[path];
+    entry.texture = texture;
+    entry.refs = texture ? 1 : 0;
+    if (texture) {
+        mByTexture[texture] = &entry;
+    }
+    return texture;
+}
+
+void TextureCache::release(SDL_Texture* texture) {
+    auto found = mByTexture.find(texture);
+    if (found != mByTexture.end() && found->second->refs > 0) {
+        --found->second->refs;
+    }
+}
+
+void TextureCache::purgeUnused() {
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (it->second.refs == 0) {
+            if (it->second.texture) {
+                mByTexture.erase(it->second.texture);
+                SDL_DestroyTexture(it->second.texture);
+            }
+            it = mEntries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TextureCache::clear() {
+    for (auto& item : mEntries) {
+        if (item.second.texture) {
+            SDL_DestroyTexture(item.second.texture);
+        }
+    }
+    mEntries.clear();
+    mByTexture.clear();
+}
+
+int TextureCache::getLoadCount() const {
+    return mLoads;
+}
@@ -0,0 +1,181 @@
+#include "waves.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+WaveScheduler::WaveScheduler(int screenWidth, int screenHeight, int enemySize)
+    : mScreenWidth(screenWidth), mScreenHeight(screenHeight), mEnemySize(enemySize),
+      mRepeat(0), mTick(0), mNext(0), mRng(0x2545F4914F6CDD1Dull) {}
+
+bool WaveScheduler::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Unable to open wave timeline " << path << std::endl;
+        return false;
+    }
+
+    std::vector<Wave> waves;
+    int repeat = 0;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string first;
+        if (!(fields >> first)) {
+            continue;
+        }
+
+        if (first == "repeat") {
+            if (!(fields >> repeat) || repeat <= 0) {
+                std::cerr << path << ":" << lineNumber << ": repeat needs a positive tick count" << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        Wave wave;
+        std::string formation;
+        std::istringstream tick(first);
+        if (!(tick >> wave.tick) || wave.tick < 0
+            || !(fields >> formation >> wave.count >> wave.y >> wave.spacing) || wave.count < 0 || wave.spacing < 0) {
+            std::cerr << path << ":" << lineNumber << ": expected TICK FORMATION COUNT Y SPACING" << std::endl;
+            return false;
+        }
+        if (formation == "column") {
+            wave.formation = FORMATION_COLUMN;
+        } else if (formation == "row") {
+            wave.formation = FORMATION_ROW;
+        } else if (formation == "wedge") {
+            wave.formation = FORMATION_WEDGE;
+        } else if (formation == "grid") {
+            wave.formation = FORMATION_GRID;
+        } else if (formation == "random") {
+            wave.formation = FORMATION_RANDOM;
+        } else {
+            std::cerr << path << ":" << lineNumber << ": unknown formation '" << formation << "'" << std::endl;
+            return false;
+        }
+        waves.push_back(wave);
+    }
+
+    std::stable_sort(waves.begin(), waves.end(), [](const Wave& a, const Wave& b) { return a.tick < b.tick; });
+    if (repeat > 0 && !waves.empty() && waves.back().tick >= repeat) {
+        std::cerr << path << ": wave at tick " << waves.back().tick << " is past repeat " << repeat << std::endl;
+        return false;
+    }
+    mWaves = waves;
+    mRepeat = repeat;
+    restart();
+    return true;
+}
+
+void WaveScheduler::useDefault(int interval) {
+    mWaves.clear();
+    mWaves.push_back({ interval - 1, FORMATION_RANDOM, 1, 0, 0 });
+    mRepeat = interval;
+    restart();
+}
+
+void WaveScheduler::restart() {
+    mTick = 0;
+    mNext = 0;
+}
+
+template <typename Emit>
+void WaveScheduler::layOut(const Wave& wave, Uint64& rng, Emit emit) const {
+    const int right = mScreenWidth;
+    int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(wave.count)))));
+    int rows = (wave.count + columns - 1) / columns;
+    for (int k = 0; k < wave.count; ++k) {
+        // Offset from the middle of the wave, in neighbours
+        int fromMiddle = k - wave.count / 2;
+        switch (wave.formation) {
+        case FORMATION_COLUMN:
+            emit(right, wave.y + fromMiddle * wave.spacing);
+            break;
+        case FORMATION_ROW:
+            emit(right + k * wave.spacing, wave.y);
+            break;
+        case FORMATION_WEDGE:
+            emit(right + std::abs(fromMiddle) * wave.spacing, wave.y + fromMiddle * wave.spacing);
+            break;
+        case FORMATION_GRID:
+            emit(right + (k % columns) * wave.spacing, wave.y + (k / columns - rows / 2) * wave.spacing);
+            break;
+        case FORMATION_RANDOM:
+            // xorshift64, so a timeline plays the same every time
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            emit(right, static_cast<int>(rng % static_cast<Uint64>(std::max(1, mScreenHeight - mEnemySize))));
+            break;
+        }
+    }
+}
+
+void WaveScheduler::update(BoxArray& enemies) {
+    while (mNext < mWaves.size() && mWaves[mNext].tick <= mTick) {
+        layOut(mWaves[mNext], mRng, [&](int x, int y) { enemies.add(x, y, mEnemySize, mEnemySize); });
+        ++mNext;
+    }
+    ++mTick;
+    if (mRepeat > 0 && mTick >= mRepeat) {
+        restart();
+    }
+}
+
+std::size_t WaveScheduler::getPeakConcurrency(int speed) const {
+    if (mWaves.empty() || speed <= 0) {
+        return 0;
+    }
+
+    // Frames from spawning at x until the update that removes it; at least
+    // one, so an enemy placed off the left edge still ends after it starts
+    auto lifetime = [&](int x) { return std::max((x + mEnemySize) / speed + 1, 1); };
+    int longest = 0;
+    Uint64 rng = mRng;
+    for (const Wave& wave : mWaves) {
+        layOut(wave, rng, [&](int x, int) { longest = std::max(longest, lifetime(x)); });
+    }
+
+    // Lay enough repeats end to end that the busiest moment of a
+    // repeating timeline is covered, then count who is alive each frame
+    int copies = mRepeat > 0 ? longest / mRepeat + 2 : 1;
+    int period = mRepeat > 0 ? mRepeat : mWaves.back().tick + 1;
+    std::vector<long long> delta(static_cast<std::size_t>(copies) * period + longest + 1, 0);
+    for (int copy = 0; copy < copies; ++copy) {
+        for (const Wave& wave : mWaves) {
+            int start = copy * period + wave.tick;
+            layOut(wave, rng, [&](int x, int) {
+                ++delta[start];
+                --delta[start + lifetime(x)];
+            });
+        }
+    }
+    long long alive = 0;
+    long long peak = 0;
+    for (long long d : delta) {
+        alive += d;
+        peak = std::max(peak, alive);
+    }
+    return static_cast<std::size_t>(peak);
+}
+
+std::size_t WaveScheduler::getLargestWave() const {
+    std::size_t largest = 0;
+    for (const Wave& wave : mWaves) {
+        largest = std::max(largest, static_cast<std::size_t>(wave.count));
+    }
+    return largest;
+}
+
+int WaveScheduler::getLength() const {
+    if (mRepeat > 0) {
+        return mRepeat;
+    }
+    return mWaves.empty() ? 0 : mWaves.back().tick + 1;
+}